@@ -0,0 +1,193 @@
+#include "Benchmark.h"
+
+#include "Arcospheres.h"
+
+#include <bit>
+#include <memory>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace
+{
+	arcospheres::State BaseState()
+	{
+		arcospheres::State state;
+
+		for (size_t i = 0; i < arcospheres::Count; i++)
+			state.myCounts[i] = 5;
+
+		return state;
+	}
+
+	void FuturePathStep(fisk::BenchmarkState& aState)
+	{
+		arcospheres::State from = BaseState();
+		from.myCounts[arcospheres::Xi]++;
+		from.myCounts[arcospheres::Epsilon]--;
+
+		while (aState.KeepRunning())
+		{
+			aState.PauseTiming();
+			std::unique_ptr<arcospheres::FuturePath> path = std::make_unique<arcospheres::FuturePath>(from, BaseState());
+			aState.ResumeTiming();
+
+			path->Step(static_cast<uint32_t>(aState.Size()));
+
+			aState.AddItems(path->mySteps);
+
+			aState.PauseTiming();
+			path.reset();
+			aState.ResumeTiming();
+		}
+	}
+
+	// Scrambles the base state with one operation per unit of size and solves the way back to completion
+	void FuturePathSolve(fisk::BenchmarkState& aState, arcospheres::FuturePath::Search aSearch)
+	{
+		arcospheres::State from = BaseState();
+
+		for (size_t i = 0; i < aState.Size(); i++)
+		{
+			if (std::optional<arcospheres::State> next = from.Modify(arcospheres::BaseOperations[(i * 3) % arcospheres::BaseOperations.size()]))
+				from = *next;
+		}
+
+		while (aState.KeepRunning())
+		{
+			arcospheres::FuturePath path(from, BaseState(), aSearch);
+
+			while (!path.Done() && !path.Failed())
+				path.Step(1000);
+
+			aState.AddItems(path.mySteps);
+		}
+	}
+
+	void FuturePathSolveForward(fisk::BenchmarkState& aState)
+	{
+		FuturePathSolve(aState, arcospheres::FuturePath::Search::Forward);
+	}
+
+	void FuturePathSolveBidirectional(fisk::BenchmarkState& aState)
+	{
+		FuturePathSolve(aState, arcospheres::FuturePath::Search::Bidirectional);
+	}
+
+	void FuturePathSolveAStar(fisk::BenchmarkState& aState)
+	{
+		FuturePathSolve(aState, arcospheres::FuturePath::Search::AStar);
+	}
+
+	void FuturePathSolveIterativeDeepening(fisk::BenchmarkState& aState)
+	{
+		FuturePathSolve(aState, arcospheres::FuturePath::Search::IterativeDeepeningAStar);
+	}
+
+	void FuturePathSolveDense(fisk::BenchmarkState& aState)
+	{
+		FuturePathSolve(aState, arcospheres::FuturePath::Search::ForwardDense);
+	}
+
+	void FuturePathSolveParallelDense(fisk::BenchmarkState& aState)
+	{
+		FuturePathSolve(aState, arcospheres::FuturePath::Search::ParallelDense);
+	}
+
+	// Random states around the base state, the same for every successor fixture
+	std::vector<arcospheres::CompactState> SuccessorInputs(size_t aCount)
+	{
+		std::vector<arcospheres::CompactState> inputs;
+		std::mt19937 rng(7);
+
+		for (size_t i = 0; i < aCount; i++)
+		{
+			arcospheres::State state;
+
+			for (uint8_t& count : state.myCounts)
+				count = static_cast<uint8_t>(rng() % 4);
+
+			inputs.push_back(state.Compact());
+		}
+
+		return inputs;
+	}
+
+	void SuccessorsModify(fisk::BenchmarkState& aState)
+	{
+		std::vector<arcospheres::CompactState> inputs = SuccessorInputs(aState.Size());
+
+		while (aState.KeepRunning())
+		{
+			arcospheres::CompactState sum = 0;
+
+			for (arcospheres::CompactState input : inputs)
+			{
+				arcospheres::State state(input);
+
+				for (const arcospheres::Operation& operation : arcospheres::BaseOperations)
+				{
+					if (std::optional<arcospheres::State> next = state.Modify(operation))
+						sum += next->Compact();
+				}
+			}
+
+			fisk::KeepAlive(sum);
+			aState.AddItems(inputs.size());
+		}
+	}
+
+	void SuccessorsPacked(fisk::BenchmarkState& aState)
+	{
+		std::vector<arcospheres::CompactState> inputs = SuccessorInputs(aState.Size());
+		const arcospheres::PackedOperations& operations = arcospheres::PackedBaseOperations;
+
+		while (aState.KeepRunning())
+		{
+			arcospheres::CompactState sum = 0;
+
+			for (arcospheres::CompactState input : inputs)
+			{
+				for (size_t op = 0; op < arcospheres::BaseOperations.size(); op++)
+				{
+					if (std::optional<arcospheres::CompactState> next = arcospheres::ApplyPacked(input, operations.myTakes[op], operations.myMakes[op]))
+						sum += *next;
+				}
+			}
+
+			fisk::KeepAlive(sum);
+			aState.AddItems(inputs.size());
+		}
+	}
+
+	void SuccessorsAll(fisk::BenchmarkState& aState)
+	{
+		std::vector<arcospheres::CompactState> inputs = SuccessorInputs(aState.Size());
+		arcospheres::PackedSuccessors successors;
+
+		while (aState.KeepRunning())
+		{
+			arcospheres::CompactState sum = 0;
+
+			for (arcospheres::CompactState input : inputs)
+			{
+				for (uint32_t applies = arcospheres::ApplyAll(input, arcospheres::PackedBaseOperations, successors); applies != 0; applies &= applies - 1)
+					sum += successors[std::countr_zero(applies)];
+			}
+
+			fisk::KeepAlive(sum);
+			aState.AddItems(inputs.size());
+		}
+	}
+
+	fisk::BenchmarkRegistration locStep("Arcospheres/FuturePath::Step", { 1'000, 10'000, 100'000 }, &FuturePathStep);
+	fisk::BenchmarkRegistration locSolveForward("Arcospheres/FuturePath forward solve", { 2, 4, 6 }, &FuturePathSolveForward);
+	fisk::BenchmarkRegistration locSolveBidirectional("Arcospheres/FuturePath bidirectional solve", { 2, 4, 6 }, &FuturePathSolveBidirectional);
+	fisk::BenchmarkRegistration locSolveAStar("Arcospheres/FuturePath A* solve", { 2, 4, 6 }, &FuturePathSolveAStar);
+	fisk::BenchmarkRegistration locSolveIterativeDeepening("Arcospheres/FuturePath IDA* solve", { 2, 4, 6 }, &FuturePathSolveIterativeDeepening);
+	fisk::BenchmarkRegistration locSolveDense("Arcospheres/FuturePath dense forward solve", { 2, 4, 6 }, &FuturePathSolveDense);
+	fisk::BenchmarkRegistration locSolveParallelDense("Arcospheres/FuturePath parallel dense solve", { 2, 4, 6 }, &FuturePathSolveParallelDense);
+	fisk::BenchmarkRegistration locSuccessorsModify("Arcospheres/Successors State::Modify", { 1'000, 100'000 }, &SuccessorsModify);
+	fisk::BenchmarkRegistration locSuccessorsPacked("Arcospheres/Successors ApplyPacked", { 1'000, 100'000 }, &SuccessorsPacked);
+	fisk::BenchmarkRegistration locSuccessorsAll("Arcospheres/Successors ApplyAll", { 1'000, 100'000 }, &SuccessorsAll);
+}
@@ -0,0 +1,254 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace fisk
+{
+	BenchmarkState::BenchmarkState(uint64_t aSize, uint64_t aIterations)
+		: mySize(aSize)
+		, myIterations(aIterations)
+	{
+	}
+
+	uint64_t BenchmarkState::Size() const
+	{
+		return mySize;
+	}
+
+	bool BenchmarkState::KeepRunning()
+	{
+		if (myDone == 0)
+			ResumeTiming();
+
+		if (myDone == myIterations)
+		{
+			PauseTiming();
+			return false;
+		}
+
+		myDone++;
+		return true;
+	}
+
+	void BenchmarkState::PauseTiming()
+	{
+		if (!myRunning)
+			return;
+
+		myElapsed += Clock::now() - myStart;
+		myRunning = false;
+	}
+
+	void BenchmarkState::ResumeTiming()
+	{
+		if (myRunning)
+			return;
+
+		myStart = Clock::now();
+		myRunning = true;
+	}
+
+	void BenchmarkState::AddItems(uint64_t aItems)
+	{
+		myItems += aItems;
+	}
+
+	double BenchmarkState::Seconds() const
+	{
+		return std::chrono::duration<double>(myElapsed).count();
+	}
+
+	uint64_t BenchmarkState::Items() const
+	{
+		return myItems;
+	}
+
+	BenchmarkRegistration::BenchmarkRegistration(const char* aName, std::initializer_list<uint64_t> aSizes, BenchmarkFunction aFunction)
+	{
+		RegisteredBenchmarks().push_back(Benchmark{ aName, aSizes, aFunction });
+	}
+
+	std::vector<Benchmark>& RegisteredBenchmarks()
+	{
+		static std::vector<Benchmark> benchmarks;
+		return benchmarks;
+	}
+}
+
+namespace
+{
+	struct Result
+	{
+		const char* myName;
+		uint64_t mySize;
+		uint64_t myIterations;
+		double myNanosecondsPerIteration;
+		double myMinNanosecondsPerIteration;
+		double myItemsPerSecond;
+	};
+
+	const size_t locRepetitions = 5;
+
+	fisk::BenchmarkState RunOnce(const fisk::Benchmark& aBenchmark, uint64_t aSize, uint64_t aIterations)
+	{
+		fisk::BenchmarkState state(aSize, aIterations);
+		aBenchmark.myFunction(state);
+
+		return state;
+	}
+
+	Result Measure(const fisk::Benchmark& aBenchmark, uint64_t aSize, double aMinSeconds)
+	{
+		uint64_t iterations = 1;
+
+		while (true)
+		{
+			double seconds = RunOnce(aBenchmark, aSize, iterations).Seconds();
+
+			if (seconds >= aMinSeconds || iterations >= (uint64_t(1) << 40))
+				break;
+
+			double scale = seconds > 0.0 ? aMinSeconds * 1.2 / seconds : 10.0;
+			iterations = std::max(iterations + 1, static_cast<uint64_t>(static_cast<double>(iterations) * std::min(scale, 10.0)));
+		}
+
+		std::vector<double> perIteration;
+		std::vector<double> itemsPerSecond;
+
+		for (size_t i = 0; i < locRepetitions; i++)
+		{
+			fisk::BenchmarkState state = RunOnce(aBenchmark, aSize, iterations);
+
+			perIteration.push_back(state.Seconds() * 1e9 / static_cast<double>(iterations));
+			itemsPerSecond.push_back(static_cast<double>(state.Items()) / state.Seconds());
+		}
+
+		std::sort(perIteration.begin(), perIteration.end());
+		std::sort(itemsPerSecond.begin(), itemsPerSecond.end());
+
+		return Result{ aBenchmark.myName, aSize, iterations, perIteration[locRepetitions / 2], perIteration[0], itemsPerSecond[locRepetitions / 2] };
+	}
+
+	void WriteJson(FILE* aFile, const std::vector<Result>& aResults)
+	{
+		fprintf(aFile, "{\n");
+		fprintf(aFile, "  \"context\": {\n");
+#if defined(__clang__)
+		fprintf(aFile, "    \"compiler\": \"clang %d.%d\",\n", __clang_major__, __clang_minor__);
+#elif defined(__GNUC__)
+		fprintf(aFile, "    \"compiler\": \"gcc %d.%d\",\n", __GNUC__, __GNUC_MINOR__);
+#elif defined(_MSC_VER)
+		fprintf(aFile, "    \"compiler\": \"msvc %d\",\n", _MSC_VER);
+#endif
+#ifdef NDEBUG
+		fprintf(aFile, "    \"assertions\": false,\n");
+#else
+		fprintf(aFile, "    \"assertions\": true,\n");
+#endif
+		fprintf(aFile, "    \"repetitions\": %zu\n", locRepetitions);
+		fprintf(aFile, "  },\n");
+		fprintf(aFile, "  \"benchmarks\": [\n");
+
+		for (size_t i = 0; i < aResults.size(); i++)
+		{
+			const Result& result = aResults[i];
+
+			fprintf(aFile, "    { \"name\": \"%s\", \"size\": %llu, \"iterations\": %llu, \"ns_per_iteration\": %.1f, \"min_ns_per_iteration\": %.1f, \"items_per_second\": %.1f }%s\n",
+				result.myName,
+				static_cast<unsigned long long>(result.mySize),
+				static_cast<unsigned long long>(result.myIterations),
+				result.myNanosecondsPerIteration,
+				result.myMinNanosecondsPerIteration,
+				result.myItemsPerSecond,
+				i + 1 < aResults.size() ? "," : "");
+		}
+
+		fprintf(aFile, "  ]\n");
+		fprintf(aFile, "}\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* filter = nullptr;
+	const char* jsonPath = nullptr;
+	double minSeconds = 0.1;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!std::strcmp(argv[i], "--filter") && i + 1 < argc)
+			filter = argv[++i];
+		else if (!std::strcmp(argv[i], "--json") && i + 1 < argc)
+			jsonPath = argv[++i];
+		else if (!std::strcmp(argv[i], "--min-time") && i + 1 < argc)
+			minSeconds = std::atof(argv[++i]);
+		else if (!std::strcmp(argv[i], "--list"))
+		{
+			for (const fisk::Benchmark& benchmark : fisk::RegisteredBenchmarks())
+				printf("%s\n", benchmark.myName);
+			return EXIT_SUCCESS;
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--filter <substring>] [--json <path|->] [--min-time <seconds>] [--list]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	bool jsonToStdout = jsonPath && !std::strcmp(jsonPath, "-");
+	FILE* table = jsonToStdout ? stderr : stdout;
+
+	std::vector<fisk::Benchmark> benchmarks = fisk::RegisteredBenchmarks();
+	std::sort(benchmarks.begin(), benchmarks.end(), [](const fisk::Benchmark& aLeft, const fisk::Benchmark& aRight)
+	{
+		return std::strcmp(aLeft.myName, aRight.myName) < 0;
+	});
+
+	std::vector<Result> results;
+
+	fprintf(table, "%-40s %10s %12s %16s %16s\n", "benchmark", "size", "iterations", "ns/iteration", "items/second");
+
+	for (const fisk::Benchmark& benchmark : benchmarks)
+	{
+		if (filter && !std::strstr(benchmark.myName, filter))
+			continue;
+
+		for (uint64_t size : benchmark.mySizes)
+		{
+			Result result = Measure(benchmark, size, minSeconds);
+			results.push_back(result);
+
+			fprintf(table, "%-40s %10llu %12llu %16.1f %16.0f\n",
+				result.myName,
+				static_cast<unsigned long long>(result.mySize),
+				static_cast<unsigned long long>(result.myIterations),
+				result.myNanosecondsPerIteration,
+				result.myItemsPerSecond);
+			fflush(table);
+		}
+	}
+
+	if (jsonToStdout)
+	{
+		WriteJson(stdout, results);
+	}
+	else if (jsonPath)
+	{
+		FILE* file = fopen(jsonPath, "w");
+
+		if (!file)
+		{
+			fprintf(stderr, "could not open %s\n", jsonPath);
+			return EXIT_FAILURE;
+		}
+
+		WriteJson(file, results);
+		fclose(file);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+namespace fisk
+{
+	class BenchmarkState
+	{
+	public:
+		BenchmarkState(uint64_t aSize, uint64_t aIterations);
+
+		uint64_t Size() const;
+		bool KeepRunning();
+
+		void PauseTiming();
+		void ResumeTiming();
+
+		void AddItems(uint64_t aItems);
+
+		double Seconds() const;
+		uint64_t Items() const;
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		uint64_t mySize;
+		uint64_t myIterations;
+		uint64_t myDone = 0;
+		uint64_t myItems = 0;
+
+		Clock::time_point myStart;
+		Clock::duration myElapsed = Clock::duration::zero();
+		bool myRunning = false;
+	};
+
+	using BenchmarkFunction = void (*)(BenchmarkState& aState);
+
+	struct Benchmark
+	{
+		const char* myName;
+		std::vector<uint64_t> mySizes;
+		BenchmarkFunction myFunction;
+	};
+
+	class BenchmarkRegistration
+	{
+	public:
+		BenchmarkRegistration(const char* aName, std::initializer_list<uint64_t> aSizes, BenchmarkFunction aFunction);
+	};
+
+	std::vector<Benchmark>& RegisteredBenchmarks();
+
+	template<class Type>
+	inline void KeepAlive(const Type& aValue)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(aValue) : "memory");
+#else
+		// The pointer itself is volatile, so the compiler has to assume the store is observed
+		static const void* volatile sink;
+		sink = &aValue;
+#endif
+	}
+}
@@ -0,0 +1,104 @@
+#include "BranchRunner.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+	const size_t unitsPerTeam = argc > 1 ? std::atoi(argv[1]) : 3'000;
+	const uint64_t forkAt = 500;
+	const uint64_t until = forkAt + 5'000;
+
+	fisk::Timeline timeline;
+	std::vector<fisk::Action> wave;
+
+	for (size_t i = 0; i < unitsPerTeam; i++)
+	{
+		wave.push_back(fisk::Action::Spawn(fisk::Team::Friend));
+		wave.push_back(fisk::Action::Spawn(fisk::Team::Foe));
+	}
+
+	timeline.InsertActions(wave, 0);
+	timeline.Seek(forkAt);
+
+	// A fork shares the original's chunks and pending events and pays only for what it writes afterwards,
+	// so what it owns has to grow with the distance it has run from the keyframe it came from
+	const uint64_t keyframe = timeline.GetKeyframeTime(forkAt);
+	fisk::Timeline fresh = timeline.Fork(keyframe, UINT64_MAX, UINT64_MAX);
+	size_t firstTick = fresh.GetOwnedBytes();
+	bool startsThere = fresh.GetTime() == keyframe;
+	bool growing = true;
+
+	printf("fork from keyframe at tick %llu owns %.1f KiB after 1 tick", static_cast<unsigned long long>(keyframe), static_cast<float>(firstTick) / 1024.f);
+
+	for (uint64_t ticks : { 10, 100, 1'000 })
+	{
+		size_t before = fresh.GetOwnedBytes();
+
+		fresh.Seek(keyframe + ticks);
+		growing = growing && fresh.GetOwnedBytes() >= before;
+		printf(", %.1f KiB after %llu", static_cast<float>(fresh.GetOwnedBytes()) / 1024.f, static_cast<unsigned long long>(ticks));
+	}
+
+	printf("\n");
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	fisk::BranchRunner runner(std::max<size_t>(std::thread::hardware_concurrency(), 2));
+	runner.Add("Baseline", timeline.Fork(forkAt, UINT64_MAX, UINT64_MAX), until);
+
+	for (size_t i = 1; i < fisk::BranchRunner::MaxBranches; i++)
+	{
+		fisk::Timeline branch = timeline.Fork(forkAt, UINT64_MAX, UINT64_MAX);
+		std::vector<fisk::Action> spawns(i * 100, fisk::Action::Spawn(fisk::Team::Foe));
+
+		branch.InsertActions(spawns, forkAt);
+		runner.Add("+" + std::to_string(i * 100) + " foes", std::move(branch), until);
+	}
+
+	std::vector<fisk::BranchView> views;
+
+	while (true)
+	{
+		runner.Capture(views);
+
+		bool done = views.size() == fisk::BranchRunner::MaxBranches;
+
+		for (const fisk::BranchView& view : views)
+			done = done && view.mySamples.back().myTime >= view.myUntil;
+
+		if (done)
+			break;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	size_t largest = 0;
+
+	for (const fisk::BranchView& view : views)
+	{
+		const fisk::BranchSample& last = view.mySamples.back();
+
+		printf("%-12s %u friends, %u foes, %.1f KiB\n", view.myLabel.c_str(), last.myFriends, last.myFoes, static_cast<float>(view.myBytes) / 1024.f);
+		largest = std::max(largest, view.myBytes);
+	}
+
+	printf("%zu branches of %llu ticks in %.3f s\n", views.size(), static_cast<unsigned long long>(until - forkAt), elapsed.count());
+
+	// Branches run without keyframes, and a fork that is left alone has to end up where the original does
+	fisk::Timeline probe = timeline.Fork(forkAt, UINT64_MAX, UINT64_MAX);
+	probe.Seek(until);
+	timeline.Seek(until);
+
+	bool same = probe.GetStateHash() == timeline.GetStateHash();
+
+	printf("keyframes held by a fork: %zu bytes\n", probe.GetKeyframeBytes());
+	printf("unedited fork: %s\n", same ? "matches the original" : "DIFFERS FROM THE ORIGINAL");
+
+	return probe.GetKeyframeBytes() == 0 && startsThere && growing && firstTick < fresh.GetOwnedBytes() && same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,99 @@
+#include "Timeline.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	std::vector<fisk::Action> Pairs(size_t aCount)
+	{
+		std::vector<fisk::Action> pairs;
+
+		for (size_t i = 0; i < aCount; i++)
+		{
+			pairs.push_back(fisk::Action::Spawn(fisk::Team::Friend));
+			pairs.push_back(fisk::Action::Spawn(fisk::Team::Foe));
+		}
+
+		return pairs;
+	}
+
+	struct Battle
+	{
+		const char* myLabel;
+		size_t myPairsPerWave;
+		fisk::TargetingPolicy::Kind myTargeting;
+		uint64_t myEditAt;
+	};
+
+	// Equal lines trading simultaneous volleys wipe each other out to the last unit, so once the extra pair
+	// is dead the world and the queue are back to what they were without it
+	void Setup(fisk::Timeline& aTimeline, const Battle& aBattle, const std::vector<fisk::Action>& aWave, uint64_t aSecondWave)
+	{
+		aTimeline.SetDamageResolution(fisk::DamageResolution::Simultaneous);
+		aTimeline.SetTargeting(aBattle.myTargeting);
+		aTimeline.InsertActions(aWave, 0);
+		aTimeline.InsertActions(aWave, aSecondWave);
+	}
+
+	bool Run(const Battle& aBattle)
+	{
+		const uint64_t secondWave = 4'000;
+		const uint64_t end = 8'000;
+
+		// Shared so every timeline spawns the same names
+		std::vector<fisk::Action> wave = Pairs(aBattle.myPairsPerWave);
+		std::vector<fisk::Action> edit = Pairs(1);
+
+		fisk::Timeline edited;
+		Setup(edited, aBattle, wave, secondWave);
+		edited.Seek(end);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		uint64_t resimulated = edited.InsertActions(edit, aBattle.myEditAt);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		fisk::Timeline replayed;
+		replayed.SetConvergenceTracking(false);
+		Setup(replayed, aBattle, wave, secondWave);
+		replayed.InsertActions(edit, aBattle.myEditAt);
+		replayed.Seek(end);
+
+		fisk::WorldSnapshot world;
+		edited.Capture(world);
+
+		uint64_t saved = edited.GetTicksSavedByConvergence();
+		bool matches = edited.GetStateHash() == replayed.GetStateHash();
+
+		printf("%s\n", aBattle.myLabel);
+		printf("edit at tick:       %llu\n", static_cast<unsigned long long>(aBattle.myEditAt));
+		printf("ticks resimulated:  %llu\n", static_cast<unsigned long long>(resimulated));
+		printf("ticks saved:        %llu\n", static_cast<unsigned long long>(saved));
+		printf("events compacted:   %llu\n", static_cast<unsigned long long>(world.myCompactedEvents));
+		printf("edit seconds:       %.4f\n", elapsed.count());
+		printf("state:              %s\n", matches ? "matches a full replay" : "DIFFERS FROM A FULL REPLAY");
+
+		return saved > 0 && matches;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const size_t pairsPerWave = argc > 1 ? std::atoi(argv[1]) : 20;
+
+	// The second battle is sized like the skirmish scenario. Its lines die a whole wave at a time, which is
+	// enough tombstones for the queue to be compacted while the edit is being resimulated.
+	const Battle battles[] = {
+		{ "small lines, first target", pairsPerWave, fisk::TargetingPolicy::Kind::First, 150 },
+		{ "skirmish sized lines, round robin", 600, fisk::TargetingPolicy::Kind::RoundRobin, 100 }
+	};
+
+	bool converged = true;
+
+	for (const Battle& battle : battles)
+		converged = Run(battle) && converged;
+
+	return converged ? EXIT_SUCCESS : EXIT_FAILURE;
+}
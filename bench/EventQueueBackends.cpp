@@ -0,0 +1,65 @@
+#include "EventQueue.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+namespace
+{
+	struct Result
+	{
+		double myNanosecondsPerEvent;
+		uint64_t myOrderHash;
+	};
+
+	Result Run(fisk::EventQueue::Backend aBackend, uint64_t aLiveUnits, uint64_t aEvents)
+	{
+		std::unique_ptr<fisk::EventQueue> queue = fisk::EventQueue::Create(aBackend);
+		std::mt19937_64 rng(1234);
+		uint64_t sequence = 0;
+
+		for (uint64_t i = 0; i < aLiveUnits; i++)
+		{
+			fisk::Event event = fisk::Event::Timer(rng() % 100, fisk::TimerCall::Attack, fisk::UnitHandle(), 100);
+			event.SetSequence(sequence++);
+			queue->Push(event);
+		}
+
+		uint64_t hash = 0xcbf29ce484222325;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		for (uint64_t i = 0; i < aEvents; i++)
+		{
+			fisk::Event top = queue->Pop();
+
+			hash = (hash ^ top.GetSequence()) * 0x100000001b3;
+
+			fisk::Event next = top.Rearmed();
+			next.SetSequence(sequence++);
+			queue->Push(next);
+		}
+
+		std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+		return { elapsed.count() / static_cast<double>(aEvents), hash };
+	}
+}
+
+int main()
+{
+	const uint64_t sizes[] = { 1'000, 100'000, 1'000'000 };
+
+	printf("%10s %14s %14s %10s\n", "units", "heap ns/event", "wheel ns/event", "same order");
+
+	for (uint64_t units : sizes)
+	{
+		uint64_t events = units * 10;
+
+		Result heap = Run(fisk::EventQueue::Backend::BinaryHeap, units, events);
+		Result wheel = Run(fisk::EventQueue::Backend::TimingWheel, units, events);
+
+		printf("%10llu %14.1f %14.1f %10s\n", static_cast<unsigned long long>(units), heap.myNanosecondsPerEvent, wheel.myNanosecondsPerEvent, heap.myOrderHash == wheel.myOrderHash ? "yes" : "NO");
+	}
+
+	return 0;
+}
@@ -0,0 +1,54 @@
+#include "Timeline.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char** argv)
+{
+	const size_t unitsPerTeam = argc > 1 ? std::atoi(argv[1]) : 50'000;
+	const uint64_t spawnTicks = 1000;
+	const uint64_t step = 10'000;
+	const uint64_t limit = 100'000'000;
+
+	fisk::Timeline timeline;
+	timeline.SetKeyframeIntervals(UINT64_MAX, UINT64_MAX);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (uint64_t tick = 0; tick < spawnTicks; tick++)
+	{
+		std::vector<fisk::Action> wave;
+
+		for (size_t i = 0; i < unitsPerTeam / spawnTicks; i++)
+		{
+			wave.push_back(fisk::Action::Spawn(fisk::Team::Friend));
+			wave.push_back(fisk::Action::Spawn(fisk::Team::Foe));
+		}
+
+		timeline.InsertActions(wave, tick);
+	}
+
+	uint64_t tick = spawnTicks;
+	size_t spawned = (unitsPerTeam / spawnTicks) * spawnTicks * 2;
+
+	timeline.Seek(tick);
+
+	while (timeline.GetUnits().Count() > spawned / 20 && tick < limit)
+	{
+		tick += step;
+		timeline.Seek(tick);
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	size_t deaths = spawned - timeline.GetUnits().Count();
+
+	printf("units spawned:     %zu\n", spawned);
+	printf("units died:        %zu\n", deaths);
+	printf("ticks simulated:   %llu\n", static_cast<unsigned long long>(tick));
+	printf("resolved events:   %llu\n", static_cast<unsigned long long>(timeline.GetResolvedEvents()));
+	printf("seconds:           %.3f\n", elapsed.count());
+	printf("events per second: %.0f\n", static_cast<double>(timeline.GetResolvedEvents()) / elapsed.count());
+
+	return 0;
+}
@@ -0,0 +1,41 @@
+#include "Benchmark.h"
+
+#include "MatrixUtils.h"
+
+namespace
+{
+	void Rotate(fisk::BenchmarkState& aState)
+	{
+		while (aState.KeepRunning())
+		{
+			for (uint64_t i = 0; i < aState.Size(); i++)
+			{
+				float angle = static_cast<float>(i) * 0.001f;
+				fisk::tools::M44F rotation = fisk::Matrix44FUtils::Rotate(fisk::tools::V3f(angle, angle * 2.f, angle * 3.f));
+
+				fisk::KeepAlive(rotation);
+			}
+
+			aState.AddItems(aState.Size());
+		}
+	}
+
+	void PerspectiveProjection(fisk::BenchmarkState& aState)
+	{
+		while (aState.KeepRunning())
+		{
+			for (uint64_t i = 0; i < aState.Size(); i++)
+			{
+				float fov = 1.f + static_cast<float>(i % 64) * 0.01f;
+				fisk::tools::M44F projection = fisk::Matrix44FUtils::PerspectiveProjection(fov, fov * 0.75f, 0.1f, 1000.f);
+
+				fisk::KeepAlive(projection);
+			}
+
+			aState.AddItems(aState.Size());
+		}
+	}
+
+	fisk::BenchmarkRegistration locRotate("Matrix/Rotate", { 1, 64, 4'096 }, &Rotate);
+	fisk::BenchmarkRegistration locPerspective("Matrix/PerspectiveProjection", { 1, 64, 4'096 }, &PerspectiveProjection);
+}
@@ -0,0 +1,88 @@
+#include "Timeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct Run
+	{
+		double mySeconds;
+		uint64_t myHash;
+		fisk::ParallelStats myStats;
+	};
+
+	// Every unit spawns on the same tick, so all attacks of a round land in one timer batch. Batches are
+	// only split over threads when damage is simultaneous, immediate damage runs serially regardless.
+	Run Battle(const std::vector<fisk::Action>& aWave, uint64_t aTicks, fisk::TargetingPolicy::Kind aTargeting, size_t aThreads)
+	{
+		fisk::Timeline timeline;
+		timeline.SetKeyframeIntervals(UINT64_MAX, UINT64_MAX);
+		timeline.SetUndoCapacity(0, 0);
+		timeline.SetDamageResolution(fisk::DamageResolution::Simultaneous);
+		timeline.SetTargeting(aTargeting);
+		timeline.SetParallelism(aThreads);
+
+		timeline.InsertActions(aWave, 0);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		timeline.Seek(aTicks);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		return Run{ elapsed.count(), timeline.GetStateHash(), timeline.GetParallelStats() };
+	}
+
+	const char* Name(fisk::TargetingPolicy::Kind aKind)
+	{
+		switch (aKind)
+		{
+		case fisk::TargetingPolicy::Kind::First: return "first";
+		case fisk::TargetingPolicy::Kind::RoundRobin: return "round robin";
+		case fisk::TargetingPolicy::Kind::MostDamaged: return "most damaged";
+		}
+
+		return "?";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const size_t unitsPerTeam = argc > 1 ? std::atoi(argv[1]) : 20'000;
+	const uint64_t ticks = argc > 2 ? std::atoi(argv[2]) : 2'000;
+	const size_t maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+
+	// Shared so every run spawns the same names
+	std::vector<fisk::Action> wave;
+
+	for (size_t i = 0; i < unitsPerTeam; i++)
+	{
+		wave.push_back(fisk::Action::Spawn(fisk::Team::Friend));
+		wave.push_back(fisk::Action::Spawn(fisk::Team::Foe));
+	}
+
+	for (fisk::TargetingPolicy::Kind kind : { fisk::TargetingPolicy::Kind::First, fisk::TargetingPolicy::Kind::RoundRobin, fisk::TargetingPolicy::Kind::MostDamaged })
+	{
+		Run serial = Battle(wave, ticks, kind, 1);
+
+		printf("%s targeting, serial: %.3f s\n", Name(kind), serial.mySeconds);
+
+		for (size_t threads = 2; threads <= maxThreads; threads *= 2)
+		{
+			Run parallel = Battle(wave, ticks, kind, threads);
+
+			printf("  %2zu threads: %.3f s, speedup %.2fx, %llu batches, %llu attacks targeted in parallel, %s\n",
+				threads,
+				parallel.mySeconds,
+				serial.mySeconds / parallel.mySeconds,
+				static_cast<unsigned long long>(parallel.myStats.myBatches),
+				static_cast<unsigned long long>(parallel.myStats.myAttacks),
+				parallel.myHash == serial.myHash ? "matches serial" : "DIVERGED FROM SERIAL");
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,105 @@
+#include "Arcospheres.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct Run
+	{
+		double mySeconds;
+		bool myDone;
+		uint64_t myExpanded;
+		std::vector<arcospheres::OperationId> myPath;
+	};
+
+	Run Solve(arcospheres::State aFrom, arcospheres::State aTo, arcospheres::FuturePath::Search aSearch, size_t aThreads)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		arcospheres::FuturePath path(aFrom, aTo, aSearch, aThreads);
+
+		while (!path.Done() && !path.Failed())
+			path.Step(100'000);
+
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		return Run{ elapsed.count(), path.Done(), path.myExpanded, path.Done() ? path.GetResult() : std::vector<arcospheres::OperationId>{} };
+	}
+
+	arcospheres::State Uniform(uint8_t aCount)
+	{
+		arcospheres::State state;
+
+		for (uint8_t& count : state.myCounts)
+			count = aCount;
+
+		return state;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const uint8_t perPolarization = static_cast<uint8_t>(argc > 1 ? std::atoi(argv[1]) : 5);
+	const size_t maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+
+	arcospheres::State goal = Uniform(perPolarization);
+
+	// Scrambled starts, the parallel search has to pick the exact path the serial one does
+	std::mt19937 rng(11);
+	size_t mismatches = 0;
+
+	for (size_t i = 0; i < 20; i++)
+	{
+		arcospheres::State from = goal;
+
+		for (size_t step = 0; step < 4 + i; step++)
+		{
+			if (std::optional<arcospheres::State> next = from.Modify(arcospheres::BaseOperations[rng() % arcospheres::BaseOperations.size()]))
+				from = *next;
+		}
+
+		Run serial = Solve(from, goal, arcospheres::FuturePath::Search::ForwardDense, 1);
+
+		for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+		{
+			Run parallel = Solve(from, goal, arcospheres::FuturePath::Search::ParallelDense, threads);
+
+			if (parallel.myDone != serial.myDone || parallel.myPath != serial.myPath)
+				mismatches++;
+		}
+	}
+
+	printf("scrambled starts: %s\n", mismatches == 0 ? "every path matches serial" : "PATHS DIFFER FROM SERIAL");
+
+	// Moving one sphere between polarizations breaks an invariant of the operations, so the goal is out of
+	// reach and the search has to exhaust every layer of the component
+	arcospheres::State deep = goal;
+	deep.myCounts[arcospheres::Xi]++;
+	deep.myCounts[arcospheres::Epsilon]--;
+	deep.myCounts[arcospheres::Theta]++;
+	deep.myCounts[arcospheres::Lambda]--;
+
+	Run serial = Solve(deep, goal, arcospheres::FuturePath::Search::ForwardDense, 1);
+
+	printf("exhaustive search, serial dense: %.3f s, %llu states\n", serial.mySeconds, static_cast<unsigned long long>(serial.myExpanded));
+
+	for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		Run parallel = Solve(deep, goal, arcospheres::FuturePath::Search::ParallelDense, threads);
+
+		printf("  %2zu threads: %.3f s, speedup %.2fx, %llu states%s\n",
+			threads,
+			parallel.mySeconds,
+			serial.mySeconds / parallel.mySeconds,
+			static_cast<unsigned long long>(parallel.myExpanded),
+			parallel.myExpanded == serial.myExpanded ? "" : ", DIFFERENT STATE COUNT");
+	}
+
+	return 0;
+}
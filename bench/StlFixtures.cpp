@@ -0,0 +1,160 @@
+#include "Benchmark.h"
+
+#include "StlImport.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// A height field of aSize * aSize quads, two triangles each, with every corner repeated per triangle like an exported STL
+	std::vector<fisk::tools::V4f> GenerateTriangles(uint64_t aSize)
+	{
+		std::vector<fisk::tools::V4f> corners;
+		corners.reserve(aSize * aSize * 6);
+
+		auto corner = [](uint64_t aX, uint64_t aY)
+		{
+			float x = static_cast<float>(aX);
+			float y = static_cast<float>(aY);
+
+			return fisk::tools::V4f(x, y, std::sin(x * 0.3f) * std::cos(y * 0.2f), 1.f);
+		};
+
+		for (uint64_t y = 0; y < aSize; y++)
+		{
+			for (uint64_t x = 0; x < aSize; x++)
+			{
+				corners.push_back(corner(x, y));
+				corners.push_back(corner(x + 1, y));
+				corners.push_back(corner(x, y + 1));
+
+				corners.push_back(corner(x + 1, y));
+				corners.push_back(corner(x + 1, y + 1));
+				corners.push_back(corner(x, y + 1));
+			}
+		}
+
+		return corners;
+	}
+
+	std::string ToAsciiStl(const std::vector<fisk::tools::V4f>& aCorners)
+	{
+		std::ostringstream out;
+		out << "solid generated\n";
+
+		for (size_t i = 0; i < aCorners.size(); i += 3)
+		{
+			out << "facet normal 0 0 1\nouter loop\n";
+
+			for (size_t j = 0; j < 3; j++)
+				out << "vertex " << aCorners[i + j][0] << " " << aCorners[i + j][1] << " " << aCorners[i + j][2] << "\n";
+
+			out << "endloop\nendfacet\n";
+		}
+
+		out << "endsolid generated\n";
+
+		return out.str();
+	}
+
+	std::string ToBinaryStl(const std::vector<fisk::tools::V4f>& aCorners)
+	{
+		std::string out(80, '\0');
+
+		auto write = [&out](const void* aData, size_t aSize)
+		{
+			out.append(static_cast<const char*>(aData), aSize);
+		};
+
+		uint32_t triangles = static_cast<uint32_t>(aCorners.size() / 3);
+		write(&triangles, sizeof(triangles));
+
+		for (size_t i = 0; i < aCorners.size(); i += 3)
+		{
+			float normal[3] = { 0.f, 0.f, 1.f };
+			write(normal, sizeof(normal));
+
+			for (size_t j = 0; j < 3; j++)
+			{
+				float position[3] = { aCorners[i + j][0], aCorners[i + j][1], aCorners[i + j][2] };
+				write(position, sizeof(position));
+			}
+
+			uint16_t attribute = 0;
+			write(&attribute, sizeof(attribute));
+		}
+
+		return out;
+	}
+
+	void RequireParsed(const std::optional<fisk::StlMesh>& aMesh, const char* aFormat)
+	{
+		if (aMesh)
+			return;
+
+		fprintf(stderr, "generated %s stl failed to parse\n", aFormat);
+		std::exit(EXIT_FAILURE);
+	}
+
+	void AsciiStl(fisk::BenchmarkState& aState)
+	{
+		std::string file = ToAsciiStl(GenerateTriangles(aState.Size()));
+
+		std::istringstream check(file);
+		RequireParsed(fisk::MeshFromAsciiStl(check), "ascii");
+
+		while (aState.KeepRunning())
+		{
+			std::istringstream stream(file);
+			std::optional<fisk::StlMesh> mesh = fisk::MeshFromAsciiStl(stream);
+
+			fisk::KeepAlive(mesh);
+			aState.AddItems(aState.Size() * aState.Size() * 2);
+		}
+	}
+
+	void BinaryStl(fisk::BenchmarkState& aState)
+	{
+		std::string file = ToBinaryStl(GenerateTriangles(aState.Size()));
+
+		std::istringstream check(file, std::ios_base::in | std::ios_base::binary);
+		RequireParsed(fisk::MeshFromBinaryStl(check), "binary");
+
+		while (aState.KeepRunning())
+		{
+			std::istringstream stream(file, std::ios_base::in | std::ios_base::binary);
+			std::optional<fisk::StlMesh> mesh = fisk::MeshFromBinaryStl(stream);
+
+			fisk::KeepAlive(mesh);
+			aState.AddItems(aState.Size() * aState.Size() * 2);
+		}
+	}
+
+	void Deduplicate(fisk::BenchmarkState& aState)
+	{
+		std::vector<fisk::tools::V4f> corners = GenerateTriangles(aState.Size());
+
+		while (aState.KeepRunning())
+		{
+			aState.PauseTiming();
+			std::vector<fisk::tools::V4f> vertexes = corners;
+			std::vector<uint32_t> indexes;
+			aState.ResumeTiming();
+
+			fisk::DeduplicateVertexes(vertexes, indexes);
+
+			fisk::KeepAlive(indexes);
+			aState.AddItems(corners.size());
+		}
+	}
+
+	fisk::BenchmarkRegistration locAscii("Stl/MeshFromAsciiStl", { 16, 64, 128 }, &AsciiStl);
+	fisk::BenchmarkRegistration locBinary("Stl/MeshFromBinaryStl", { 16, 64, 128 }, &BinaryStl);
+	fisk::BenchmarkRegistration locDeduplicate("Stl/DeduplicateVertexes", { 16, 64, 128 }, &Deduplicate);
+}
@@ -0,0 +1,69 @@
+#include "Timeline.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<uint64_t> locAllocations = 0;
+}
+
+void* operator new(size_t aSize)
+{
+	locAllocations++;
+
+	if (void* memory = std::malloc(aSize ? aSize : 1))
+		return memory;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* aMemory) noexcept
+{
+	std::free(aMemory);
+}
+
+void operator delete(void* aMemory, size_t) noexcept
+{
+	std::free(aMemory);
+}
+
+int main(int argc, char** argv)
+{
+	const int unitsPerTeam = argc > 1 ? std::atoi(argv[1]) : 200;
+	const uint64_t warmupTicks = 10'000;
+	const uint64_t measuredTicks = 1'000'000;
+
+	fisk::Timeline timeline;
+	timeline.SetKeyframeIntervals(UINT64_MAX, UINT64_MAX);
+	timeline.SetConvergenceTracking(false);
+
+	for (int i = 0; i < unitsPerTeam; i++)
+	{
+		timeline.SpawnFriend();
+		timeline.SpawnFoe();
+	}
+
+	timeline.Seek(warmupTicks);
+
+	uint64_t allocationsBefore = locAllocations;
+	uint64_t eventsBefore = timeline.GetResolvedEvents();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	timeline.Seek(warmupTicks + measuredTicks);
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	uint64_t allocations = locAllocations - allocationsBefore;
+	uint64_t events = timeline.GetResolvedEvents() - eventsBefore;
+
+	printf("units per team:    %d\n", unitsPerTeam);
+	printf("resolved events:   %llu\n", static_cast<unsigned long long>(events));
+	printf("heap allocations:  %llu\n", static_cast<unsigned long long>(allocations));
+	printf("allocs per event:  %f\n", events ? static_cast<double>(allocations) / static_cast<double>(events) : 0.0);
+	printf("events per second: %.0f\n", static_cast<double>(events) / elapsed.count());
+
+	return allocations == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
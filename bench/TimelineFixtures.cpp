@@ -0,0 +1,133 @@
+#include "Benchmark.h"
+
+#include "Timeline.h"
+
+#include <memory>
+#include <vector>
+
+namespace
+{
+	std::unique_ptr<fisk::Timeline> MakeBattle(uint64_t aUnitsPerTeam)
+	{
+		std::unique_ptr<fisk::Timeline> timeline = std::make_unique<fisk::Timeline>();
+		timeline->SetKeyframeIntervals(UINT64_MAX, UINT64_MAX);
+		timeline->SetConvergenceTracking(false);
+
+		timeline->SpawnWave(fisk::Team::Friend, aUnitsPerTeam);
+		timeline->SpawnWave(fisk::Team::Foe, aUnitsPerTeam);
+
+		return timeline;
+	}
+
+	void TimelineGoto(fisk::BenchmarkState& aState)
+	{
+		while (aState.KeepRunning())
+		{
+			aState.PauseTiming();
+			std::unique_ptr<fisk::Timeline> timeline = MakeBattle(aState.Size());
+			uint64_t before = timeline->GetResolvedEvents();
+			aState.ResumeTiming();
+
+			timeline->Seek(1000);
+
+			aState.AddItems(timeline->GetResolvedEvents() - before);
+
+			aState.PauseTiming();
+			timeline.reset();
+			aState.ResumeTiming();
+		}
+	}
+
+	void TimelineAdvance(fisk::BenchmarkState& aState)
+	{
+		while (aState.KeepRunning())
+		{
+			aState.PauseTiming();
+			std::unique_ptr<fisk::Timeline> timeline = MakeBattle(aState.Size());
+			uint64_t before = timeline->GetResolvedEvents();
+			aState.ResumeTiming();
+
+			for (int i = 0; i < 1000; i++)
+				timeline->Advance();
+
+			aState.AddItems(timeline->GetResolvedEvents() - before);
+
+			aState.PauseTiming();
+			timeline.reset();
+			aState.ResumeTiming();
+		}
+	}
+
+	void TimelineFastForward(fisk::BenchmarkState& aState)
+	{
+		while (aState.KeepRunning())
+		{
+			aState.PauseTiming();
+			std::unique_ptr<fisk::Timeline> timeline = MakeBattle(aState.Size());
+			uint64_t before = timeline->GetResolvedEvents();
+			aState.ResumeTiming();
+
+			timeline->Advance(1000);
+
+			aState.AddItems(timeline->GetResolvedEvents() - before);
+
+			aState.PauseTiming();
+			timeline.reset();
+			aState.ResumeTiming();
+		}
+	}
+
+	void TimelineStepBack(fisk::BenchmarkState& aState)
+	{
+		while (aState.KeepRunning())
+		{
+			aState.PauseTiming();
+			std::unique_ptr<fisk::Timeline> timeline = MakeBattle(aState.Size());
+			timeline->Seek(1000);
+			aState.ResumeTiming();
+
+			timeline->Seek(400);
+
+			aState.AddItems(600);
+
+			aState.PauseTiming();
+			timeline.reset();
+			aState.ResumeTiming();
+		}
+	}
+
+	template<fisk::EventQueue::Backend Backend>
+	void TimelineFlushBurst(fisk::BenchmarkState& aState)
+	{
+		const uint64_t spread = 64;
+
+		fisk::Timeline timeline;
+		timeline.SetQueueBackend(Backend);
+		timeline.SetKeyframeIntervals(UINT64_MAX, UINT64_MAX);
+		timeline.SetConvergenceTracking(false);
+
+		std::vector<fisk::Event> burst;
+		burst.reserve(aState.Size());
+
+		while (aState.KeepRunning())
+		{
+			aState.PauseTiming();
+			burst.clear();
+			for (uint64_t i = 0; i < aState.Size(); i++)
+				burst.push_back(fisk::Event::Timer(timeline.GetTime(1 + i % spread), fisk::TimerCall::Attack, fisk::UnitHandle(), fisk::Timeline::AttackPeriod));
+			aState.ResumeTiming();
+
+			timeline.QueueEvents(burst);
+			timeline.Advance();
+
+			aState.AddItems(aState.Size());
+		}
+	}
+
+	fisk::BenchmarkRegistration locGoto("Timeline/Goto", { 100, 1'000, 10'000 }, &TimelineGoto);
+	fisk::BenchmarkRegistration locAdvance("Timeline/Advance", { 100, 1'000, 10'000 }, &TimelineAdvance);
+	fisk::BenchmarkRegistration locFastForward("Timeline/FastForward", { 100, 1'000, 10'000 }, &TimelineFastForward);
+	fisk::BenchmarkRegistration locStepBack("Timeline/StepBack", { 100, 1'000, 10'000 }, &TimelineStepBack);
+	fisk::BenchmarkRegistration locFlushHeap("Timeline/FlushBurst/Heap", { 16, 1'024, 65'536 }, &TimelineFlushBurst<fisk::EventQueue::Backend::BinaryHeap>);
+	fisk::BenchmarkRegistration locFlushWheel("Timeline/FlushBurst/Wheel", { 16, 1'024, 65'536 }, &TimelineFlushBurst<fisk::EventQueue::Backend::TimingWheel>);
+}
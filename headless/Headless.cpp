@@ -0,0 +1,80 @@
+#include "Scenario.h"
+#include "Timeline.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+	size_t PeakMemoryBytes()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+
+		return counters.PeakWorkingSetSize;
+#else
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+
+		return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s <scenario>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::ifstream file(argv[1]);
+
+	if (!file)
+	{
+		fprintf(stderr, "could not open %s\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	std::string error;
+	std::optional<fisk::Scenario> scenario = fisk::Scenario::Parse(file, error);
+
+	if (!scenario)
+	{
+		fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+		return EXIT_FAILURE;
+	}
+
+	fisk::Timeline timeline;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	fisk::ScenarioStats stats = scenario->Run(timeline);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	printf("scenario:          %s\n", argv[1]);
+	printf("steps:             %zu\n", scenario->GetSteps().size());
+	printf("final tick:        %llu\n", static_cast<unsigned long long>(timeline.GetTime()));
+	printf("units alive:       %zu\n", timeline.GetUnits().Count());
+	printf("ticks simulated:   %llu\n", static_cast<unsigned long long>(stats.myTicks));
+	printf("events resolved:   %llu\n", static_cast<unsigned long long>(stats.myEvents));
+	printf("events cancelled:  %llu\n", static_cast<unsigned long long>(stats.myCancelledEvents));
+	printf("path steps:        %llu\n", static_cast<unsigned long long>(stats.myPathSteps));
+	printf("seconds:           %.3f\n", elapsed.count());
+	printf("ticks per second:  %.0f\n", static_cast<double>(stats.myTicks) / elapsed.count());
+	printf("events per second: %.0f\n", static_cast<double>(stats.myEvents) / elapsed.count());
+	printf("peak memory:       %.1f MB\n", static_cast<double>(PeakMemoryBytes()) / (1024.0 * 1024.0));
+
+	return EXIT_SUCCESS;
+}
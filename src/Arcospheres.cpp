@@ -1,21 +1,166 @@
 
 #include "Arcospheres.h"
 
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <thread>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 namespace arcospheres
 {
-	std::array<Operation, 10> BaseOperations =
-	{ {
-		{.myTakes = { Zeta, Theta, Gamma, Omega },.myMakes = { Lambda, Xi, Epsilon, Phi }},
-		{.myTakes = { Lambda, Xi, Epsilon, Phi },.myMakes = { Zeta, Theta, Gamma, Omega }},
-		{.myTakes = { Lambda, Omega },.myMakes = { Xi, Theta }},
-		{.myTakes = { Xi, Gamma },.myMakes = { Zeta, Lambda }},
-		{.myTakes = { Xi, Zeta },.myMakes = { Theta, Phi }},
-		{.myTakes = { Lambda, Theta },.myMakes = { Epsilon, Zeta }},
-		{.myTakes = { Theta, Epsilon},.myMakes = { Phi, Omega}},
-		{.myTakes = { Zeta, Phi },.myMakes = { Gamma, Epsilon }},
-		{.myTakes = { Phi, Gamma },.myMakes = { Omega, Xi }},
-		{.myTakes = { Epsilon, Omega },.myMakes = { Lambda, Gamma }}
-	} };
+	constexpr CompactState PackLanes(std::initializer_list<Polarization> aPolarizations)
+	{
+		CompactState packed = 0;
+
+		for (Polarization pol : aPolarizations)
+			packed += CompactState(1) << (pol * State::CompactFieldBitWidth);
+
+		return packed;
+	}
+
+	constexpr PackedOperations PadOperations(const std::array<std::array<CompactState, 2>, 10>& aOperations)
+	{
+		PackedOperations packed{};
+
+		for (size_t i = 0; i < PackedOperations::Lanes; i++)
+		{
+			packed.myTakes[i] = i < aOperations.size() ? aOperations[i][0] : ~CompactState(0);
+			packed.myMakes[i] = i < aOperations.size() ? aOperations[i][1] : 0;
+		}
+
+		return packed;
+	}
+
+	constexpr PackedOperations SwapOperations(const PackedOperations& aOperations)
+	{
+		PackedOperations swapped = aOperations;
+
+		for (size_t i = 0; i < std::tuple_size_v<decltype(BaseOperations)>; i++)
+		{
+			swapped.myTakes[i] = aOperations.myMakes[i];
+			swapped.myMakes[i] = aOperations.myTakes[i];
+		}
+
+		return swapped;
+	}
+
+	std::array<Operation, 10> UnpackOperations(const PackedOperations& aOperations)
+	{
+		std::array<Operation, 10> operations;
+
+		for (size_t i = 0; i < operations.size(); i++)
+		{
+			for (int pol = 0; pol < Polarization::Count; pol++)
+			{
+				CompactState shift = pol * State::CompactFieldBitWidth;
+
+				for (CompactState n = 0; n < ((aOperations.myTakes[i] >> shift) & State::CompactFieldBitMask); n++)
+					operations[i].myTakes.push_back(static_cast<Polarization>(pol));
+
+				for (CompactState n = 0; n < ((aOperations.myMakes[i] >> shift) & State::CompactFieldBitMask); n++)
+					operations[i].myMakes.push_back(static_cast<Polarization>(pol));
+			}
+		}
+
+		return operations;
+	}
+
+	constexpr PackedOperations PackedBaseOperations = PadOperations({ {
+		{ PackLanes({ Zeta, Theta, Gamma, Omega }), PackLanes({ Lambda, Xi, Epsilon, Phi }) },
+		{ PackLanes({ Lambda, Xi, Epsilon, Phi }), PackLanes({ Zeta, Theta, Gamma, Omega }) },
+		{ PackLanes({ Lambda, Omega }), PackLanes({ Xi, Theta }) },
+		{ PackLanes({ Xi, Gamma }), PackLanes({ Zeta, Lambda }) },
+		{ PackLanes({ Xi, Zeta }), PackLanes({ Theta, Phi }) },
+		{ PackLanes({ Lambda, Theta }), PackLanes({ Epsilon, Zeta }) },
+		{ PackLanes({ Theta, Epsilon }), PackLanes({ Phi, Omega }) },
+		{ PackLanes({ Zeta, Phi }), PackLanes({ Gamma, Epsilon }) },
+		{ PackLanes({ Phi, Gamma }), PackLanes({ Omega, Xi }) },
+		{ PackLanes({ Epsilon, Omega }), PackLanes({ Lambda, Gamma }) }
+	} });
+
+	constexpr PackedOperations PackedReversedOperations = SwapOperations(PackedBaseOperations);
+
+	std::array<Operation, 10> BaseOperations = UnpackOperations(PackedBaseOperations);
+
+	std::array<Operation, 10> ReversedOperations = UnpackOperations(PackedReversedOperations);
+
+	std::optional<CompactState> ApplyPacked(CompactState aState, CompactState aTakes, CompactState aMakes)
+	{
+		// Byte lane subtraction and addition that keep the top bit of each lane out of the carry chain
+		constexpr CompactState high = 0x8080808080808080ull;
+
+		CompactState difference = ((aState | high) - (aTakes & ~high)) ^ ((aState ^ ~aTakes) & high);
+		CompactState borrow = ((~aState & aTakes) | (~(aState ^ aTakes) & difference)) & high;
+
+		if (borrow != 0)
+			return {};
+
+		return ((difference & ~high) + (aMakes & ~high)) ^ ((difference ^ aMakes) & high);
+	}
+
+	uint32_t ApplyAll(CompactState aState, const PackedOperations& aOperations, PackedSuccessors& aOut)
+	{
+		uint32_t applies = 0;
+
+#if defined(__AVX2__)
+		__m256i state = _mm256_set1_epi64x(static_cast<long long>(aState));
+		__m256i allLanes = _mm256_set1_epi8(-1);
+
+		for (size_t i = 0; i < PackedOperations::Lanes; i += 4)
+		{
+			__m256i takes = _mm256_load_si256(reinterpret_cast<const __m256i*>(&aOperations.myTakes[i]));
+			__m256i makes = _mm256_load_si256(reinterpret_cast<const __m256i*>(&aOperations.myMakes[i]));
+
+			__m256i enough = _mm256_cmpeq_epi8(_mm256_max_epu8(state, takes), state);
+			__m256i whole = _mm256_cmpeq_epi64(enough, allLanes);
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&aOut[i]), _mm256_add_epi8(_mm256_sub_epi8(state, takes), makes));
+			applies |= static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(whole))) << i;
+		}
+#else
+		for (size_t i = 0; i < PackedOperations::Lanes; i++)
+		{
+			if (std::optional<CompactState> next = ApplyPacked(aState, aOperations.myTakes[i], aOperations.myMakes[i]))
+			{
+				aOut[i] = *next;
+				applies |= 1u << i;
+			}
+		}
+#endif
+
+		return applies & ((1u << std::tuple_size_v<decltype(BaseOperations)>) - 1);
+	}
+
+	uint32_t LargestChange(const std::array<Operation, 10>& aOperations)
+	{
+		uint32_t largest = 1;
+
+		for (const Operation& operation : aOperations)
+		{
+			std::array<int, Polarization::Count> delta = {};
+
+			for (Polarization pol : operation.myTakes)
+				delta[pol]--;
+
+			for (Polarization pol : operation.myMakes)
+				delta[pol]++;
+
+			uint32_t change = 0;
+
+			for (int moved : delta)
+				change += static_cast<uint32_t>(std::abs(moved));
+
+			largest = std::max(largest, change);
+		}
+
+		return largest;
+	}
+
+	uint32_t MaxOperationChange = LargestChange(BaseOperations);
 
 	std::vector<OperationId> UnwindPath(CompactState aStart, CompactState aEnd, std::unordered_map<CompactState, Node>& aMap)
 	{
@@ -178,46 +323,175 @@ namespace arcospheres
 		return out;
 	}
 
+	StateRanking::StateRanking(uint32_t aTotal)
+		: myTotal(aTotal)
+		, myBinomials(aTotal + Bars + 1)
+	{
+		for (size_t n = 0; n < myBinomials.size(); n++)
+		{
+			myBinomials[n][0] = 1;
+
+			for (size_t k = 1; k <= Bars; k++)
+				myBinomials[n][k] = n == 0 ? 0 : myBinomials[n - 1][k - 1] + myBinomials[n - 1][k];
+		}
+	}
+
+	uint64_t StateRanking::Size() const
+	{
+		return myBinomials[myTotal + Bars][Bars];
+	}
+
+	uint64_t StateRanking::Rank(const State& aState) const
+	{
+		uint64_t rank = 0;
+		uint32_t position = 0;
+
+		for (size_t bar = 0; bar < Bars; bar++)
+		{
+			position += aState.myCounts[bar];
+			rank += myBinomials[position + bar][bar + 1];
+		}
+
+		return rank;
+	}
+
+	uint64_t StateRanking::Rank(CompactState aState) const
+	{
+		uint64_t rank = 0;
+		uint32_t position = 0;
+
+		for (size_t bar = 0; bar < Bars; bar++)
+		{
+			position += (aState >> (bar * State::CompactFieldBitWidth)) & State::CompactFieldBitMask;
+			rank += myBinomials[position + bar][bar + 1];
+		}
+
+		return rank;
+	}
+
+	uint32_t StateRanking::TotalOf(const State& aState)
+	{
+		uint32_t total = 0;
+
+		for (uint8_t count : aState.myCounts)
+			total += count;
+
+		return total;
+	}
+
 	std::vector<CompactState> Node::Explore(CompactState thisState, std::unordered_map<CompactState, Node>& aMap)
 	{
 		std::vector<CompactState> out;
-		State current(thisState);
+		PackedSuccessors successors;
 
-		for (OperationId i = 0; i < BaseOperations.size(); i++)
+		for (uint32_t applies = ApplyAll(thisState, PackedBaseOperations, successors); applies != 0; applies &= applies - 1)
 		{
-			std::optional<State> next = current.Modify(BaseOperations[i]);
+			OperationId i = static_cast<OperationId>(std::countr_zero(applies));
+			CompactState next = successors[i];
 
-			if (!next)
-				continue;
-
-			aMap[thisState].myReachable[i] = next->Compact();
+			aMap[thisState].myReachable[i] = next;
 
-			if (!aMap[next->Compact()].myFirstDiscoveredFrom)
+			if (!aMap[next].myFirstDiscoveredFrom)
 			{
-				out.push_back(next->Compact());
-				aMap[next->Compact()].myFirstDiscoveredFrom = Node::Link{ .myFromState = thisState, .myOperation = i };
+				out.push_back(next);
+				aMap[next].myFirstDiscoveredFrom = Node::Link{ .myFromState = thisState, .myOperation = i };
 			}
 		}
 
 		return out;
 	}
 
-	FuturePath::FuturePath(CompactState aStart, CompactState aEnd)
+	FuturePath::FuturePath(CompactState aStart, CompactState aEnd, Search aSearch, size_t aThreads)
 	{
 		myStart = aStart;
 		myEnd = aEnd;
+		mySearch = aSearch;
 
 		myMap[myStart];
-		myQueue.push(myStart);
+
+		switch (mySearch)
+		{
+		case Search::Forward:
+		case Search::Bidirectional:
+			myQueue.push(myStart);
+			break;
+		case Search::AStar:
+			myOpen.push(OpenNode{ Heuristic(myStart, myEnd), 0, myStart });
+			return;
+		case Search::ForwardDense:
+		case Search::ParallelDense:
+		{
+			uint32_t total = StateRanking::TotalOf(State(myStart));
+
+			if (StateRanking(total).Size() > MaxDenseStates)
+			{
+				mySearch = Search::Forward;
+				myQueue.push(myStart);
+				return;
+			}
+
+			myMap.clear();
+			myRanking.emplace(total);
+
+			if (myStart == myEnd)
+			{
+				myPath.emplace();
+				return;
+			}
+
+			// Operations keep the total, a goal holding a different number of spheres is out of reach
+			if (StateRanking::TotalOf(State(myEnd)) != total)
+				return;
+
+			myVisited.assign(myRanking->Size() / 64 + 1, 0);
+			myParents = std::make_unique_for_overwrite<OperationId[]>(myRanking->Size());
+
+			Visit(myStart, 0);
+
+			if (mySearch == Search::ParallelDense)
+			{
+				myPool = std::make_unique<fisk::WorkerPool>(aThreads != 0 ? aThreads : std::max(std::thread::hardware_concurrency(), 1u));
+
+				// Whole words of myVisited per bucket, so claiming a bucket touches nothing another one does
+				myBucketWidth = (myRanking->Size() / RankBuckets / 64 + 1) * 64;
+				myFrontier.push_back(myStart);
+				return;
+			}
+
+			myQueue.push(myStart);
+			return;
+		}
+		case Search::IterativeDeepeningAStar:
+			myMap.clear();
+
+			if (myStart == myEnd)
+			{
+				myPath.emplace();
+				return;
+			}
+
+			myNextBound = Heuristic(myStart, myEnd);
+			StartIteration();
+			return;
+		}
+
+		if (mySearch == Search::Bidirectional)
+		{
+			if (myStart == myEnd)
+			{
+				myPath.emplace();
+				myQueue = decltype(myQueue)();
+				return;
+			}
+
+			myBackwardMap[myEnd];
+			myBackwardQueue.push(myEnd);
+		}
 	}
 
-	FuturePath::FuturePath(State aStart, State aEnd)
+	FuturePath::FuturePath(State aStart, State aEnd, Search aSearch, size_t aThreads)
+		: FuturePath(aStart.Compact(), aEnd.Compact(), aSearch, aThreads)
 	{
-		myStart = aStart.Compact();
-		myEnd = aEnd.Compact();
-
-		myMap[myStart];
-		myQueue.push(myStart);
 	}
 
 	std::vector<OperationId> FuturePath::GetResult()
@@ -227,7 +501,34 @@ namespace arcospheres
 
 	bool FuturePath::Failed()
 	{
-		return !Done() && myQueue.empty();
+		return !Done() && myQueue.empty() && myBackwardQueue.empty() && myOpen.empty() && myStack.empty() && myFrontier.empty();
+	}
+
+	size_t FuturePath::GetStoredNodes()
+	{
+		return myMap.size() + myBackwardMap.size() + myStack.size() + myVisitedCount;
+	}
+
+	uint32_t FuturePath::Heuristic(CompactState aFrom, CompactState aTo)
+	{
+		State from(aFrom);
+		State to(aTo);
+		uint32_t distance = 0;
+
+		for (size_t i = 0; i < Polarization::Count; i++)
+			distance += static_cast<uint32_t>(std::abs(static_cast<int>(from.myCounts[i]) - static_cast<int>(to.myCounts[i])));
+
+		return (distance + MaxOperationChange - 1) / MaxOperationChange;
+	}
+
+	bool FuturePath::OpenNode::operator<(const OpenNode& aOther) const
+	{
+		// std::priority_queue pops the largest, so the lowest estimate has to compare largest. Ties go to
+		// the deepest node, it is the one closest to the goal.
+		if (myEstimate != aOther.myEstimate)
+			return myEstimate > aOther.myEstimate;
+
+		return myDepth < aOther.myDepth;
 	}
 
 	bool FuturePath::Done()
@@ -236,6 +537,31 @@ namespace arcospheres
 	}
 
 	void FuturePath::Step(uint32_t aIterations)
+	{
+		switch (mySearch)
+		{
+		case Search::Forward:
+			StepForward(aIterations);
+			break;
+		case Search::Bidirectional:
+			StepBidirectional(aIterations);
+			break;
+		case Search::AStar:
+			StepAStar(aIterations);
+			break;
+		case Search::IterativeDeepeningAStar:
+			StepIterativeDeepening(aIterations);
+			break;
+		case Search::ForwardDense:
+			StepDense(aIterations);
+			break;
+		case Search::ParallelDense:
+			StepParallelDense(aIterations);
+			break;
+		}
+	}
+
+	void FuturePath::StepForward(uint32_t aIterations)
 	{
 		for (uint32_t i = 0; i < aIterations; i++)
 		{
@@ -243,6 +569,7 @@ namespace arcospheres
 				break;
 
 			mySteps++;
+			myExpanded++;
 
 			CompactState current = myQueue.front();
 			myQueue.pop();
@@ -260,4 +587,444 @@ namespace arcospheres
 			}
 		}
 	}
-}
\ No newline at end of file
+
+	void FuturePath::StepBidirectional(uint32_t aIterations)
+	{
+		for (uint32_t i = 0; i < aIterations; i++)
+		{
+			if (myLayerLeft == 0)
+			{
+				// Every meeting in a layer has been seen once it is done, so the best of them is a shortest path
+				if (myMeeting)
+				{
+					Stitch(*myMeeting);
+					return;
+				}
+
+				// One side ran dry without meeting the other, nothing it left out can reach across
+				if (myQueue.empty() || myBackwardQueue.empty())
+				{
+					myQueue = decltype(myQueue)();
+					myBackwardQueue = decltype(myBackwardQueue)();
+					return;
+				}
+
+				myExpandingBackward = myBackwardQueue.size() < myQueue.size();
+				myLayerLeft = myExpandingBackward ? myBackwardQueue.size() : myQueue.size();
+			}
+
+			std::queue<CompactState>& queue = myExpandingBackward ? myBackwardQueue : myQueue;
+			std::unordered_map<CompactState, Node>& map = myExpandingBackward ? myBackwardMap : myMap;
+			std::unordered_map<CompactState, Node>& other = myExpandingBackward ? myMap : myBackwardMap;
+			const PackedOperations& operations = myExpandingBackward ? PackedReversedOperations : PackedBaseOperations;
+			CompactState root = myExpandingBackward ? myEnd : myStart;
+			CompactState otherRoot = myExpandingBackward ? myStart : myEnd;
+
+			mySteps++;
+			myExpanded++;
+			myLayerLeft--;
+
+			CompactState current = queue.front();
+			queue.pop();
+
+			uint32_t depth = map[current].myDepth + 1;
+			PackedSuccessors successors;
+
+			for (uint32_t applies = ApplyAll(current, operations, successors); applies != 0; applies &= applies - 1)
+			{
+				OperationId op = static_cast<OperationId>(std::countr_zero(applies));
+				CompactState compact = successors[op];
+				Node& node = map[compact];
+
+				if (compact == root || node.myFirstDiscoveredFrom)
+					continue;
+
+				node.myFirstDiscoveredFrom = Node::Link{ .myFromState = current, .myOperation = op };
+				node.myDepth = depth;
+				queue.push(compact);
+
+				auto seen = other.find(compact);
+
+				if (seen == other.end() || (compact != otherRoot && !seen->second.myFirstDiscoveredFrom))
+					continue;
+
+				uint32_t length = depth + seen->second.myDepth;
+
+				if (!myMeeting || length < myMeetingLength)
+				{
+					myMeeting = compact;
+					myMeetingLength = length;
+				}
+			}
+		}
+	}
+
+	void FuturePath::StepAStar(uint32_t aIterations)
+	{
+		for (uint32_t i = 0; i < aIterations; i++)
+		{
+			if (myOpen.empty())
+				break;
+
+			mySteps++;
+
+			OpenNode open = myOpen.top();
+			myOpen.pop();
+
+			// Reached again along a shorter path after this entry was queued
+			if (open.myDepth > myMap[open.myState].myDepth)
+				continue;
+
+			// The heuristic never drops by more than one per operation, so the first time the goal comes
+			// off the queue it is through a shortest path
+			if (open.myState == myEnd)
+			{
+				myPath = UnwindPath(myStart, myEnd, myMap);
+				myOpen = decltype(myOpen)();
+				return;
+			}
+
+			myExpanded++;
+
+			uint32_t depth = open.myDepth + 1;
+			PackedSuccessors successors;
+
+			for (uint32_t applies = ApplyAll(open.myState, PackedBaseOperations, successors); applies != 0; applies &= applies - 1)
+			{
+				OperationId op = static_cast<OperationId>(std::countr_zero(applies));
+				CompactState compact = successors[op];
+
+				if (compact == myStart)
+					continue;
+
+				auto [at, inserted] = myMap.try_emplace(compact);
+				Node& node = at->second;
+
+				if (!inserted && node.myDepth <= depth)
+					continue;
+
+				node.myFirstDiscoveredFrom = Node::Link{ .myFromState = open.myState, .myOperation = op };
+				node.myDepth = depth;
+				myOpen.push(OpenNode{ depth + Heuristic(compact, myEnd), depth, compact });
+			}
+		}
+	}
+
+	void FuturePath::StepIterativeDeepening(uint32_t aIterations)
+	{
+		for (uint32_t i = 0; i < aIterations && !myStack.empty(); i++)
+		{
+			mySteps++;
+
+			PathFrame& frame = myStack.back();
+
+			if (frame.myNextOperation == BaseOperations.size())
+			{
+				myStack.pop_back();
+
+				// Nothing was cut off by the last bound when it runs out, the whole reachable space has been searched
+				if (myStack.empty() && myNextBound != UINT32_MAX)
+					StartIteration();
+
+				continue;
+			}
+
+			OperationId op = frame.myNextOperation++;
+			std::optional<CompactState> next = ApplyPacked(frame.myState, PackedBaseOperations.myTakes[op], PackedBaseOperations.myMakes[op]);
+
+			if (!next)
+				continue;
+
+			CompactState compact = *next;
+			uint32_t depth = static_cast<uint32_t>(myStack.size());
+			uint32_t estimate = depth + Heuristic(compact, myEnd);
+
+			if (estimate > myBound)
+			{
+				myNextBound = std::min(myNextBound, estimate);
+				continue;
+			}
+
+			if (SeenShallower(compact, depth))
+				continue;
+
+			if (std::any_of(myStack.begin(), myStack.end(), [compact](const PathFrame& aFrame) { return aFrame.myState == compact; }))
+				continue;
+
+			if (compact == myEnd)
+			{
+				std::vector<OperationId> path;
+
+				for (const PathFrame& onPath : myStack)
+					path.push_back(onPath.myNextOperation - 1);
+
+				myPath = std::move(path);
+				myStack.clear();
+				return;
+			}
+
+			myStack.push_back(PathFrame{ compact, 0 });
+			myExpanded++;
+		}
+	}
+
+	void FuturePath::StepDense(uint32_t aIterations)
+	{
+		for (uint32_t i = 0; i < aIterations; i++)
+		{
+			if (myQueue.empty())
+				break;
+
+			mySteps++;
+			myExpanded++;
+
+			CompactState current = myQueue.front();
+			myQueue.pop();
+
+			PackedSuccessors successors;
+
+			for (uint32_t applies = ApplyAll(current, PackedBaseOperations, successors); applies != 0; applies &= applies - 1)
+			{
+				OperationId op = static_cast<OperationId>(std::countr_zero(applies));
+				CompactState compact = successors[op];
+
+				if (!Visit(compact, op))
+					continue;
+
+				if (compact == myEnd)
+				{
+					myPath = UnwindDense();
+					myQueue = decltype(myQueue)();
+					return;
+				}
+
+				myQueue.push(compact);
+			}
+		}
+	}
+
+	void FuturePath::StepParallelDense(uint32_t aIterations)
+	{
+		size_t budget = aIterations;
+
+		while (budget > 0 && !myFrontier.empty())
+		{
+			size_t chunks = (myFrontier.size() + FrontierChunkStates - 1) / FrontierChunkStates;
+
+			if (myChunks.size() < chunks)
+				myChunks.resize(chunks);
+
+			size_t first = myExpandedChunks;
+			size_t last = std::min(chunks, first + std::max<size_t>(budget / FrontierChunkStates, 1));
+
+			myPool->ParallelFor(last - first, [this, first](size_t aIndex) { ExpandChunk(first + aIndex); }, 1);
+
+			size_t states = std::min(last * FrontierChunkStates, myFrontier.size()) - first * FrontierChunkStates;
+
+			mySteps += static_cast<uint32_t>(states);
+			myExpanded += states;
+			budget -= std::min(budget, states);
+			myExpandedChunks = last;
+
+			if (myExpandedChunks == chunks)
+				FinishLayer();
+		}
+	}
+
+	void FuturePath::ExpandChunk(size_t aChunk)
+	{
+		FrontierChunk& chunk = myChunks[aChunk];
+		size_t begin = aChunk * FrontierChunkStates;
+		size_t end = std::min(begin + FrontierChunkStates, myFrontier.size());
+
+		std::array<uint32_t, RankBuckets> counts{};
+		PackedSuccessors successors;
+
+		chunk.myCandidates.clear();
+
+		// Nothing writes myVisited until the whole layer is expanded, it only holds earlier layers here
+		for (size_t i = begin; i < end; i++)
+		{
+			for (uint32_t applies = ApplyAll(myFrontier[i], PackedBaseOperations, successors); applies != 0; applies &= applies - 1)
+			{
+				OperationId op = static_cast<OperationId>(std::countr_zero(applies));
+				uint64_t rank = myRanking->Rank(successors[op]);
+
+				if (myVisited[rank / 64] & (uint64_t(1) << (rank % 64)))
+					continue;
+
+				chunk.myCandidates.push_back(Candidate{ successors[op], static_cast<uint32_t>(rank), op, false });
+				counts[rank / myBucketWidth]++;
+			}
+		}
+
+		uint32_t start = 0;
+
+		for (size_t bucket = 0; bucket < RankBuckets; bucket++)
+		{
+			chunk.myBucketStarts[bucket] = start;
+			start += counts[bucket];
+		}
+
+		chunk.myBucketStarts[RankBuckets] = start;
+		chunk.myByBucket.resize(chunk.myCandidates.size());
+
+		std::array<uint32_t, RankBuckets + 1> next = chunk.myBucketStarts;
+
+		for (uint32_t index = 0; index < chunk.myCandidates.size(); index++)
+			chunk.myByBucket[next[chunk.myCandidates[index].myRank / myBucketWidth]++] = index;
+	}
+
+	size_t FuturePath::ClaimBucket(size_t aBucket)
+	{
+		size_t chunks = (myFrontier.size() + FrontierChunkStates - 1) / FrontierChunkStates;
+		size_t claimed = 0;
+
+		// Chunks in frontier order and candidates in the order they were found, the first to claim a state
+		// is the one the serial search would have queued it from
+		for (size_t c = 0; c < chunks; c++)
+		{
+			FrontierChunk& chunk = myChunks[c];
+
+			for (uint32_t at = chunk.myBucketStarts[aBucket]; at < chunk.myBucketStarts[aBucket + 1]; at++)
+			{
+				Candidate& candidate = chunk.myCandidates[chunk.myByBucket[at]];
+				uint64_t& word = myVisited[candidate.myRank / 64];
+				uint64_t bit = uint64_t(1) << (candidate.myRank % 64);
+
+				if (word & bit)
+					continue;
+
+				word |= bit;
+				myParents[candidate.myRank] = candidate.myOperation;
+				candidate.myFirst = true;
+				claimed++;
+			}
+		}
+
+		return claimed;
+	}
+
+	void FuturePath::FinishLayer()
+	{
+		size_t chunks = (myFrontier.size() + FrontierChunkStates - 1) / FrontierChunkStates;
+		std::array<size_t, RankBuckets> claimed;
+
+		myPool->ParallelFor(RankBuckets, [this, &claimed](size_t aBucket) { claimed[aBucket] = ClaimBucket(aBucket); }, 1);
+
+		for (size_t count : claimed)
+			myVisitedCount += count;
+
+		myExpandedChunks = 0;
+
+		uint64_t end = myRanking->Rank(myEnd);
+
+		if (myVisited[end / 64] & (uint64_t(1) << (end % 64)))
+		{
+			myPath = UnwindDense();
+			myFrontier.clear();
+			return;
+		}
+
+		myPool->ParallelFor(chunks, [this](size_t aChunk)
+		{
+			std::erase_if(myChunks[aChunk].myCandidates, [](const Candidate& aCandidate) { return !aCandidate.myFirst; });
+		}, 1);
+
+		std::vector<size_t> offsets(chunks + 1, 0);
+
+		for (size_t c = 0; c < chunks; c++)
+			offsets[c + 1] = offsets[c] + myChunks[c].myCandidates.size();
+
+		std::vector<CompactState> next(offsets[chunks]);
+
+		myPool->ParallelFor(chunks, [this, &offsets, &next](size_t aChunk)
+		{
+			size_t at = offsets[aChunk];
+
+			for (const Candidate& candidate : myChunks[aChunk].myCandidates)
+				next[at++] = candidate.myState;
+		}, 1);
+
+		myFrontier = std::move(next);
+	}
+
+	bool FuturePath::Visit(CompactState aState, OperationId aFrom)
+	{
+		uint64_t rank = myRanking->Rank(aState);
+		uint64_t& word = myVisited[rank / 64];
+		uint64_t bit = uint64_t(1) << (rank % 64);
+
+		if (word & bit)
+			return false;
+
+		word |= bit;
+		myParents[rank] = aFrom;
+		myVisitedCount++;
+
+		return true;
+	}
+
+	std::vector<OperationId> FuturePath::UnwindDense()
+	{
+		std::vector<OperationId> path;
+
+		// Only the operation is stored, undoing it gives the state it was applied to
+		CompactState at = myEnd;
+		while (at != myStart)
+		{
+			OperationId op = myParents[myRanking->Rank(at)];
+
+			path.push_back(op);
+			at = *ApplyPacked(at, PackedReversedOperations.myTakes[op], PackedReversedOperations.myMakes[op]);
+		}
+
+		std::reverse(path.begin(), path.end());
+
+		return path;
+	}
+
+	void FuturePath::StartIteration()
+	{
+		myBound = myNextBound;
+		myNextBound = UINT32_MAX;
+
+		myTranspositions.assign(TranspositionSlots, Transposition{ 0, UINT32_MAX });
+		SeenShallower(myStart, 0);
+
+		myStack.push_back(PathFrame{ myStart, 0 });
+		myExpanded++;
+	}
+
+	bool FuturePath::SeenShallower(CompactState aState, uint32_t aDepth)
+	{
+		// A state already searched this iteration from no deeper had at least as much of the bound left,
+		// the goal would have been found under it. Collisions just overwrite, losing only the pruning.
+		Transposition& slot = myTranspositions[(aState * 0x9E3779B97F4A7C15ull >> 40) % TranspositionSlots];
+
+		if (slot.myState == aState && slot.myDepth <= aDepth)
+			return true;
+
+		slot = Transposition{ aState, aDepth };
+		return false;
+	}
+
+	void FuturePath::Stitch(CompactState aMeeting)
+	{
+		std::vector<OperationId> path = UnwindPath(myStart, aMeeting, myMap);
+
+		// Backward links point towards the goal and carry the operation that gets there
+		CompactState at = aMeeting;
+		while (at != myEnd)
+		{
+			Node::Link link = *myBackwardMap[at].myFirstDiscoveredFrom;
+
+			path.push_back(link.myOperation);
+			at = link.myFromState;
+		}
+
+		myPath = std::move(path);
+		myQueue = decltype(myQueue)();
+		myBackwardQueue = decltype(myBackwardQueue)();
+	}
+}
@@ -3,9 +3,14 @@
 #include <vector>
 #include <optional>
 #include <array>
+#include <cstdint>
+#include <initializer_list>
 #include <string>
 #include <unordered_map>
 #include <queue>
+#include <memory>
+
+#include "WorkerPool.h"
 
 namespace arcospheres
 {
@@ -33,6 +38,12 @@ namespace arcospheres
 
 	extern std::array<Operation, 10> BaseOperations;
 
+	// BaseOperations with takes and makes swapped, applying entry i undoes BaseOperations[i]
+	extern std::array<Operation, 10> ReversedOperations;
+
+	// Largest number of sphere counts a single BaseOperations entry moves, summed over polarizations
+	extern uint32_t MaxOperationChange;
+
 	using OperationId = uint8_t;
 
 	using CompactState = uint64_t;
@@ -52,6 +63,49 @@ namespace arcospheres
 		std::array<uint8_t, Polarization::Count> myCounts;
 	};
 
+	// Operations in the CompactState layout, a byte lane per polarization holding how many of it are taken
+	// or made. Padded with operations that never apply so the table fills whole 256 bit vectors.
+	struct PackedOperations
+	{
+		static constexpr size_t Lanes = 12;
+
+		alignas(32) std::array<CompactState, Lanes> myTakes;
+		alignas(32) std::array<CompactState, Lanes> myMakes;
+	};
+
+	using PackedSuccessors = std::array<CompactState, PackedOperations::Lanes>;
+
+	// Built at compile time, BaseOperations and ReversedOperations are unpacked from these
+	extern const PackedOperations PackedBaseOperations;
+	extern const PackedOperations PackedReversedOperations;
+
+	// Takes and makes on every lane at once, without unpacking. Empty if any lane would go below zero.
+	std::optional<CompactState> ApplyPacked(CompactState aState, CompactState aTakes, CompactState aMakes);
+
+	// Every operation of the table at once, with AVX2 when the build enables it. Bit i of the result is
+	// set when operation i applies, aOut[i] is only meaningful then.
+	uint32_t ApplyAll(CompactState aState, const PackedOperations& aOperations, PackedSuccessors& aOut);
+
+	// Ranks every state holding aTotal spheres into [0, Size()) without gaps. The running sums of the counts
+	// mark where the bars go in a stars and bars layout, and the bar positions are ranked with the
+	// combinatorial number system. Every operation keeps the total, so one ranking covers a whole search.
+	struct StateRanking
+	{
+		StateRanking(uint32_t aTotal);
+
+		uint64_t Size() const;
+		uint64_t Rank(const State& aState) const;
+		uint64_t Rank(CompactState aState) const;
+
+		static uint32_t TotalOf(const State& aState);
+
+	private:
+		static constexpr size_t Bars = Polarization::Count - 1;
+
+		uint32_t myTotal;
+		std::vector<std::array<uint64_t, Bars + 1>> myBinomials;
+	};
+
 	struct Node
 	{
 		std::array<std::optional<CompactState>, std::tuple_size_v<decltype(BaseOperations)>> myReachable;
@@ -62,14 +116,46 @@ namespace arcospheres
 		};
 
 		std::optional<Link> myFirstDiscoveredFrom;
+		uint32_t myDepth = 0;
 
 		std::vector<CompactState> Explore(CompactState thisState, std::unordered_map<CompactState, Node>& aMap);
 	};
 
 	struct FuturePath
 	{
-		FuturePath(CompactState aStart, CompactState aEnd);
-		FuturePath(State aStart, State aEnd);
+		static constexpr size_t TranspositionSlots = 1 << 16;
+
+		enum class Search
+		{
+			// Breadth first from the start until the goal is found
+			Forward,
+			// Alternates whole layers from the start and, through ReversedOperations, from the goal,
+			// always growing the smaller frontier, until the two meet
+			Bidirectional,
+			// Best first on depth plus Heuristic, keeps every node it has seen
+			AStar,
+			// Depth first under a growing bound on depth plus Heuristic, keeps only the current path and a
+			// fixed size table of recently seen states
+			IterativeDeepeningAStar,
+			// Forward over arrays indexed by StateRanking, a visited bit and a parent operation byte per
+			// state the sphere total allows. Falls back to Forward when that space is too large.
+			ForwardDense,
+			// ForwardDense a whole layer at a time on a worker pool, finds the same path as ForwardDense
+			ParallelDense
+		};
+
+		static constexpr uint64_t MaxDenseStates = uint64_t(1) << 30;
+		static_assert(MaxDenseStates <= UINT32_MAX, "ParallelDense keeps ranks in 32 bits");
+
+		static constexpr size_t FrontierChunkStates = 256;
+		static constexpr size_t RankBuckets = 256;
+
+		// Lower bound on the operations left, each one changes the counts by at most MaxOperationChange
+		static uint32_t Heuristic(CompactState aFrom, CompactState aTo);
+
+		// aThreads is only used by ParallelDense, 0 takes one per hardware thread
+		FuturePath(CompactState aStart, CompactState aEnd, Search aSearch = Search::Forward, size_t aThreads = 0);
+		FuturePath(State aStart, State aEnd, Search aSearch = Search::Forward, size_t aThreads = 0);
 
 		CompactState myStart;
 		CompactState myEnd;
@@ -80,12 +166,95 @@ namespace arcospheres
 
 		void Step(uint32_t aIterations);
 
+		size_t GetStoredNodes();
+
 		uint32_t mySteps = 0;
+		uint64_t myExpanded = 0;
 
 	private:
+		struct OpenNode
+		{
+			uint32_t myEstimate;
+			uint32_t myDepth;
+			CompactState myState;
+
+			bool operator<(const OpenNode& aOther) const;
+		};
+
+		struct PathFrame
+		{
+			CompactState myState;
+			OperationId myNextOperation;
+		};
+
+		struct Transposition
+		{
+			CompactState myState;
+			uint32_t myDepth;
+		};
+
+		struct Candidate
+		{
+			CompactState myState;
+			uint32_t myRank;
+			OperationId myOperation;
+			bool myFirst;
+		};
+
+		// What one slice of the frontier discovers, in the order the serial search would queue it and
+		// indexed by which range of ranks each candidate falls in
+		struct FrontierChunk
+		{
+			std::vector<Candidate> myCandidates;
+			std::vector<uint32_t> myByBucket;
+			std::array<uint32_t, RankBuckets + 1> myBucketStarts;
+		};
+
+		void StepForward(uint32_t aIterations);
+		void StepBidirectional(uint32_t aIterations);
+		void StepAStar(uint32_t aIterations);
+		void StepIterativeDeepening(uint32_t aIterations);
+		void StepDense(uint32_t aIterations);
+		void StepParallelDense(uint32_t aIterations);
+		void ExpandChunk(size_t aChunk);
+		size_t ClaimBucket(size_t aBucket);
+		void FinishLayer();
+		bool Visit(CompactState aState, OperationId aFrom);
+		std::vector<OperationId> UnwindDense();
+		void Stitch(CompactState aMeeting);
+		void StartIteration();
+		bool SeenShallower(CompactState aState, uint32_t aDepth);
+
+		Search mySearch;
+
 		std::queue<CompactState> myQueue;
 		std::unordered_map<CompactState, Node> myMap;
 		std::optional<std::vector<OperationId>> myPath;
+
+		std::queue<CompactState> myBackwardQueue;
+		std::unordered_map<CompactState, Node> myBackwardMap;
+		bool myExpandingBackward = false;
+		size_t myLayerLeft = 0;
+		std::optional<CompactState> myMeeting;
+		uint32_t myMeetingLength = 0;
+
+		std::priority_queue<OpenNode> myOpen;
+
+		std::vector<PathFrame> myStack;
+		std::vector<Transposition> myTranspositions;
+		uint32_t myBound = 0;
+		uint32_t myNextBound = UINT32_MAX;
+
+		std::optional<StateRanking> myRanking;
+		std::vector<uint64_t> myVisited;
+		std::unique_ptr<OperationId[]> myParents;
+		size_t myVisitedCount = 0;
+
+		std::unique_ptr<fisk::WorkerPool> myPool;
+		std::vector<CompactState> myFrontier;
+		std::vector<FrontierChunk> myChunks;
+		size_t myExpandedChunks = 0;
+		uint64_t myBucketWidth = 0;
 	};
 
 	std::string OperationToString(OperationId aOperation);
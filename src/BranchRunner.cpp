@@ -0,0 +1,146 @@
+#include "BranchRunner.h"
+
+#include <algorithm>
+
+namespace fisk
+{
+	BranchRunner::BranchRunner(size_t aThreads)
+		: myPool(aThreads)
+	{
+		myThread = std::thread(&BranchRunner::Run, this);
+	}
+
+	BranchRunner::~BranchRunner()
+	{
+		{
+			std::lock_guard lock(myMutex);
+			myStopping = true;
+		}
+
+		myWake.notify_one();
+		myThread.join();
+	}
+
+	bool BranchRunner::Add(std::string aLabel, Timeline&& aBranch, uint64_t aUntil)
+	{
+		{
+			std::lock_guard lock(myMutex);
+
+			if (myViews.size() + myAdded.size() >= MaxBranches)
+				return false;
+
+			Branch& branch = myAdded.emplace_back(Branch{ std::move(aBranch), BranchView{} });
+			branch.myView.myLabel = std::move(aLabel);
+			branch.myView.myFrom = branch.myTimeline.GetTime();
+			branch.myView.myUntil = aUntil;
+			Sample(branch);
+		}
+
+		myWake.notify_one();
+		return true;
+	}
+
+	void BranchRunner::Clear()
+	{
+		{
+			std::lock_guard lock(myMutex);
+			myAdded.clear();
+			myViews.clear();
+			myClear = true;
+		}
+
+		myWake.notify_one();
+	}
+
+	size_t BranchRunner::Count()
+	{
+		std::lock_guard lock(myMutex);
+
+		return myViews.size() + myAdded.size();
+	}
+
+	void BranchRunner::Capture(std::vector<BranchView>& aOut)
+	{
+		std::lock_guard lock(myMutex);
+
+		aOut = myViews;
+	}
+
+	void BranchRunner::Run()
+	{
+		std::vector<Branch> branches;
+		std::vector<size_t> active;
+
+		while (true)
+		{
+			{
+				std::unique_lock lock(myMutex);
+				myWake.wait(lock, [&]() { return myStopping || myClear || !myAdded.empty() || !active.empty(); });
+
+				if (myStopping)
+					return;
+
+				if (myClear)
+				{
+					branches.clear();
+					myClear = false;
+				}
+
+				for (Branch& branch : myAdded)
+				{
+					myViews.push_back(branch.myView);
+					branches.push_back(std::move(branch));
+				}
+
+				myAdded.clear();
+			}
+
+			active.clear();
+
+			for (size_t i = 0; i < branches.size(); i++)
+			{
+				if (branches[i].myTimeline.GetTime() < branches[i].myView.myUntil)
+					active.push_back(i);
+			}
+
+			if (active.empty())
+				continue;
+
+			// Each branch is a whole timeline, so they are handed out one at a time
+			myPool.ParallelFor(active.size(), [&](size_t aIndex)
+			{
+				Branch& branch = branches[active[aIndex]];
+				Timeline& timeline = branch.myTimeline;
+
+				timeline.Seek(std::min(timeline.GetTime() + SampleInterval, branch.myView.myUntil));
+				Sample(branch);
+			}, 1);
+
+			std::lock_guard lock(myMutex);
+
+			// A clear that arrived during the round has already emptied the views
+			if (myClear)
+				continue;
+
+			for (size_t index : active)
+				myViews[index] = branches[index].myView;
+		}
+	}
+
+	void BranchRunner::Sample(Branch& aBranch)
+	{
+		const UnitStore& units = aBranch.myTimeline.GetUnits();
+		BranchSample sample{ aBranch.myTimeline.GetTime(), 0, 0 };
+
+		units.ForEach([&](UnitHandle aUnit)
+		{
+			if (units.GetTeam(aUnit) == Team::Friend)
+				sample.myFriends++;
+			else
+				sample.myFoes++;
+		});
+
+		aBranch.myView.mySamples.push_back(sample);
+		aBranch.myView.myBytes = aBranch.myTimeline.GetOwnedBytes();
+	}
+}
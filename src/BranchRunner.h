@@ -0,0 +1,74 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Timeline.h"
+#include "WorkerPool.h"
+
+namespace fisk
+{
+	struct BranchSample
+	{
+		uint64_t myTime;
+		uint32_t myFriends;
+		uint32_t myFoes;
+	};
+
+	struct BranchView
+	{
+		std::string myLabel;
+		uint64_t myFrom = 0;
+		uint64_t myUntil = 0;
+		// What the branch has not been able to share with the timeline it was forked from
+		size_t myBytes = 0;
+		std::vector<BranchSample> mySamples;
+	};
+
+	// Simulates "what if" forks of a timeline side by side. Every branch is a Timeline::Fork owned by
+	// the runner; its own thread advances all of them in rounds, spreading the branches of a
+	// round over a worker pool, and records unit counts after each round for comparison.
+	class BranchRunner
+	{
+	public:
+		static constexpr size_t MaxBranches = 8;
+		static constexpr uint64_t SampleInterval = 50;
+
+		BranchRunner(size_t aThreads);
+		~BranchRunner();
+
+		BranchRunner(const BranchRunner&) = delete;
+		BranchRunner& operator=(const BranchRunner&) = delete;
+
+		bool Add(std::string aLabel, Timeline&& aBranch, uint64_t aUntil);
+		void Clear();
+		size_t Count();
+
+		void Capture(std::vector<BranchView>& aOut);
+
+	private:
+		struct Branch
+		{
+			Timeline myTimeline;
+			BranchView myView;
+		};
+
+		void Run();
+		static void Sample(Branch& aBranch);
+
+		WorkerPool myPool;
+
+		std::mutex myMutex;
+		std::condition_variable myWake;
+		std::vector<Branch> myAdded;
+		std::vector<BranchView> myViews;
+		bool myClear = false;
+		bool myStopping = false;
+
+		std::thread myThread;
+	};
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace fisk
+{
+	// Growable array stored as page sized chunks. Copies of a column share their chunks, and a write
+	// copies only the chunk it lands in, so a copy costs memory in proportion to what it changes
+	// afterwards. A chunk grows like a vector until it is full so short columns stay small, and chunks
+	// past the end are kept for reuse the same way a vector keeps its capacity.
+	template<class Type>
+	class ChunkedColumn
+	{
+	public:
+		static constexpr size_t ChunkSize = std::bit_floor(std::max<size_t>(4096 / sizeof(Type), 1));
+		static constexpr size_t ChunkBits = std::countr_zero(ChunkSize);
+
+		size_t Size() const
+		{
+			return mySize;
+		}
+
+		bool Empty() const
+		{
+			return mySize == 0;
+		}
+
+		const Type& operator[](size_t aIndex) const
+		{
+			return myData[aIndex >> ChunkBits][aIndex & (ChunkSize - 1)];
+		}
+
+		const Type& Back() const
+		{
+			return (*this)[mySize - 1];
+		}
+
+		Type& Mutable(size_t aIndex)
+		{
+			return Detach(aIndex >> ChunkBits)[aIndex & (ChunkSize - 1)];
+		}
+
+		void Push(const Type& aValue)
+		{
+			size_t chunk = mySize >> ChunkBits;
+
+			if (chunk == myChunks.size())
+			{
+				myChunks.push_back(std::make_shared<Chunk>());
+				myData.push_back(nullptr);
+			}
+
+			Chunk& target = Detach(chunk);
+			target.push_back(aValue);
+			myData[chunk] = target.data();
+			mySize++;
+		}
+
+		void Pop()
+		{
+			mySize--;
+			Detach(mySize >> ChunkBits).pop_back();
+		}
+
+		void Resize(size_t aSize, const Type& aValue)
+		{
+			while (mySize > aSize)
+				Pop();
+
+			while (mySize < aSize)
+				Push(aValue);
+		}
+
+		void Clear()
+		{
+			for (size_t i = 0; i < myChunks.size(); i++)
+			{
+				if (myChunks[i].use_count() == 1)
+				{
+					myChunks[i]->clear();
+				}
+				else
+				{
+					myChunks[i] = std::make_shared<Chunk>();
+					myData[i] = nullptr;
+				}
+			}
+
+			mySize = 0;
+		}
+
+		size_t ChunkCount() const
+		{
+			return (mySize + ChunkSize - 1) >> ChunkBits;
+		}
+
+		std::span<const Type> ChunkAt(size_t aChunk) const
+		{
+			return std::span<const Type>(myData[aChunk], myChunks[aChunk]->size());
+		}
+
+		std::span<Type> MutableChunkAt(size_t aChunk)
+		{
+			return Detach(aChunk);
+		}
+
+		size_t Bytes() const
+		{
+			size_t bytes = myChunks.capacity() * (sizeof(std::shared_ptr<Chunk>) + sizeof(Type*));
+
+			for (const std::shared_ptr<Chunk>& chunk : myChunks)
+				bytes += chunk->capacity() * sizeof(Type);
+
+			return bytes;
+		}
+
+		// Only the chunks no other copy of the column holds
+		size_t OwnedBytes() const
+		{
+			size_t bytes = myChunks.capacity() * (sizeof(std::shared_ptr<Chunk>) + sizeof(Type*));
+
+			for (const std::shared_ptr<Chunk>& chunk : myChunks)
+			{
+				if (chunk.use_count() == 1)
+					bytes += chunk->capacity() * sizeof(Type);
+			}
+
+			return bytes;
+		}
+
+	private:
+		using Chunk = std::vector<Type>;
+
+		Chunk& Detach(size_t aChunk)
+		{
+			std::shared_ptr<Chunk>& chunk = myChunks[aChunk];
+
+			if (chunk.use_count() == 1)
+			{
+				// The last other holder may have let go on another thread, its reads come before our writes
+				std::atomic_thread_fence(std::memory_order_acquire);
+				return *chunk;
+			}
+
+			chunk = std::make_shared<Chunk>(chunk->begin(), chunk->end());
+			myData[aChunk] = chunk->data();
+
+			return *chunk;
+		}
+
+		// Reads go straight through these, they are refreshed whenever a chunk moves
+		std::vector<std::shared_ptr<Chunk>> myChunks;
+		std::vector<Type*> myData;
+		size_t mySize = 0;
+	};
+}
\ No newline at end of file
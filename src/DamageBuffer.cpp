@@ -0,0 +1,53 @@
+#include "DamageBuffer.h"
+
+namespace fisk
+{
+	void DamageBuffer::Add(UnitHandle aUnit, int aAmount)
+	{
+		if (aAmount <= 0)
+			return;
+
+		if (aUnit.myIndex >= myAmounts.size())
+			myAmounts.resize(aUnit.myIndex + 1, 0);
+
+		int& amount = myAmounts[aUnit.myIndex];
+
+		if (amount == 0)
+			myUnits.push_back(aUnit);
+
+		amount += aAmount;
+	}
+
+	bool DamageBuffer::Empty() const
+	{
+		return myUnits.empty();
+	}
+
+	size_t DamageBuffer::Size() const
+	{
+		return myUnits.size();
+	}
+
+	std::span<const int> DamageBuffer::Amounts() const
+	{
+		return myAmounts;
+	}
+
+	int DamageBuffer::AmountOf(UnitHandle aUnit) const
+	{
+		return myAmounts[aUnit.myIndex];
+	}
+
+	std::span<const UnitHandle> DamageBuffer::Units() const
+	{
+		return myUnits;
+	}
+
+	void DamageBuffer::Clear()
+	{
+		for (UnitHandle unit : myUnits)
+			myAmounts[unit.myIndex] = 0;
+
+		myUnits.clear();
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "UnitStore.h"
+
+namespace fisk
+{
+	enum class DamageResolution : uint8_t
+	{
+		// Every hit lands as it is dealt, later attacks in the tick see the result
+		Immediate,
+		// Hits dealt during a tick are summed per unit and land together once the tick has drained
+		Simultaneous
+	};
+
+	// Damage dealt during one tick, summed per unit slot. Units are handed back in the order they were
+	// first hit so that applying the buffer is deterministic.
+	class DamageBuffer
+	{
+	public:
+		void Add(UnitHandle aUnit, int aAmount);
+		bool Empty() const;
+		size_t Size() const;
+
+		// Drops the hits on units that aGone says have left since they were dealt
+		template<class Predicate>
+		void Discard(Predicate&& aGone);
+
+		// Indexed by unit slot, zero where nothing landed
+		std::span<const int> Amounts() const;
+		int AmountOf(UnitHandle aUnit) const;
+		std::span<const UnitHandle> Units() const;
+		void Clear();
+
+	private:
+		std::vector<int> myAmounts;
+		std::vector<UnitHandle> myUnits;
+	};
+
+	template<class Predicate>
+	inline void DamageBuffer::Discard(Predicate&& aGone)
+	{
+		std::erase_if(myUnits, [&](UnitHandle aUnit)
+		{
+			if (!aGone(aUnit))
+				return false;
+
+			myAmounts[aUnit.myIndex] = 0;
+			return true;
+		});
+	}
+}
\ No newline at end of file
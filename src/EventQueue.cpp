@@ -0,0 +1,417 @@
+#include "EventQueue.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace fisk
+{
+	std::unique_ptr<EventQueue> EventQueue::Create(Backend aBackend)
+	{
+		switch (aBackend)
+		{
+		case Backend::BinaryHeap:
+			return std::make_unique<HeapEventQueue>();
+		case Backend::TimingWheel:
+			return std::make_unique<TimingWheelEventQueue>();
+		}
+		return nullptr;
+	}
+
+	void EventQueue::PushBatch(std::span<const Event> aEvents)
+	{
+		for (const Event& event : aEvents)
+			Push(event);
+	}
+
+	void EventQueue::Assign(const std::vector<Event>& aEvents, uint64_t aNow)
+	{
+		Clear(aNow);
+
+		std::vector<Event> sorted = aEvents;
+		std::sort(sorted.begin(), sorted.end(), [](const Event& aLeft, const Event& aRight)
+		{
+			return aRight < aLeft;
+		});
+
+		for (const Event& event : sorted)
+			Push(event);
+	}
+
+	void EventQueue::AssignShared(std::shared_ptr<const std::vector<Event>> aEvents, uint64_t aNow)
+	{
+		Assign(*aEvents, aNow);
+	}
+
+	EventQueue::Backend HeapEventQueue::GetBackend() const
+	{
+		return Backend::BinaryHeap;
+	}
+
+	void HeapEventQueue::Push(const Event& aEvent)
+	{
+		myEvents.push_back(aEvent);
+		std::push_heap(myEvents.begin(), myEvents.end());
+	}
+
+	void HeapEventQueue::PushBatch(std::span<const Event> aEvents)
+	{
+		size_t total = myEvents.size() + aEvents.size();
+
+		// Sifting each event up costs about log2(total) comparisons, rebuilding costs about 2 * total
+		if (aEvents.size() * std::bit_width(total) <= 2 * total)
+		{
+			for (const Event& event : aEvents)
+				Push(event);
+			return;
+		}
+
+		myEvents.insert(myEvents.end(), aEvents.begin(), aEvents.end());
+		std::make_heap(myEvents.begin(), myEvents.end());
+	}
+
+	Event HeapEventQueue::Pop()
+	{
+		Event top = myEvents[0];
+
+		std::pop_heap(myEvents.begin(), myEvents.end());
+		myEvents.pop_back();
+
+		return top;
+	}
+
+	const Event& HeapEventQueue::Peek()
+	{
+		return myEvents[0];
+	}
+
+	bool HeapEventQueue::Empty() const
+	{
+		return myEvents.empty();
+	}
+
+	size_t HeapEventQueue::Size() const
+	{
+		return myEvents.size();
+	}
+
+	uint64_t HeapEventQueue::NextTime() const
+	{
+		return myEvents[0].GetWhen();
+	}
+
+	void HeapEventQueue::Clear(uint64_t)
+	{
+		myEvents.clear();
+	}
+
+	void HeapEventQueue::Assign(const std::vector<Event>& aEvents, uint64_t)
+	{
+		myEvents = aEvents;
+		std::make_heap(myEvents.begin(), myEvents.end());
+	}
+
+	void HeapEventQueue::Collect(std::vector<Event>& aOut) const
+	{
+		aOut.insert(aOut.end(), myEvents.begin(), myEvents.end());
+	}
+
+	size_t HeapEventQueue::OwnedBytes() const
+	{
+		return myEvents.capacity() * sizeof(Event);
+	}
+
+	EventQueue::Backend TimingWheelEventQueue::GetBackend() const
+	{
+		return Backend::TimingWheel;
+	}
+
+	void TimingWheelEventQueue::Push(const Event& aEvent)
+	{
+		assert(aEvent.GetWhen() >= myCursor && "Timing wheel can't schedule into the past");
+
+		uint32_t level = LevelOf(aEvent.GetWhen());
+		uint32_t index = (aEvent.GetWhen() >> (level * SlotBits)) & (SlotCount - 1);
+
+		Slot& slot = myLevels[level][index];
+
+		if (level == 0 && slot.myEvents.size() > slot.myHead && aEvent.GetSequence() < slot.myEvents.back().GetSequence())
+		{
+			auto after = std::upper_bound(slot.myEvents.begin() + slot.myHead, slot.myEvents.end(), aEvent, [](const Event& aLeft, const Event& aRight)
+			{
+				return aLeft.GetSequence() < aRight.GetSequence();
+			});
+			slot.myEvents.insert(after, aEvent);
+		}
+		else
+		{
+			slot.myEvents.push_back(aEvent);
+		}
+
+		slot.myMinTime = std::min(slot.myMinTime, aEvent.GetWhen());
+
+		myOccupied[level][index / 64] |= uint64_t(1) << (index % 64);
+		mySize++;
+	}
+
+	Event TimingWheelEventQueue::Pop()
+	{
+		int index = FrontSlot();
+
+		Slot& slot = myLevels[0][index];
+		Event top = slot.myEvents[slot.myHead++];
+
+		if (slot.myHead == slot.myEvents.size())
+			Release(0, index);
+
+		myCursor = top.GetWhen();
+		mySize--;
+
+		return top;
+	}
+
+	const Event& TimingWheelEventQueue::Peek()
+	{
+		Slot& slot = myLevels[0][FrontSlot()];
+
+		return slot.myEvents[slot.myHead];
+	}
+
+	bool TimingWheelEventQueue::Empty() const
+	{
+		return mySize == 0;
+	}
+
+	size_t TimingWheelEventQueue::Size() const
+	{
+		return mySize;
+	}
+
+	uint64_t TimingWheelEventQueue::NextTime() const
+	{
+		int index = FirstOccupied(0);
+
+		if (index >= 0)
+			return (myCursor & ~uint64_t(SlotCount - 1)) | static_cast<uint64_t>(index);
+
+		for (uint32_t level = 1; level < LevelCount; level++)
+		{
+			index = FirstOccupied(level);
+
+			if (index >= 0)
+				return myLevels[level][index].myMinTime;
+		}
+
+		return UINT64_MAX;
+	}
+
+	void TimingWheelEventQueue::Clear(uint64_t aNow)
+	{
+		for (uint32_t level = 0; level < LevelCount; level++)
+		{
+			for (int index = FirstOccupied(level); index >= 0; index = FirstOccupied(level))
+				Release(level, index);
+		}
+
+		myCursor = aNow;
+		mySize = 0;
+	}
+
+	void TimingWheelEventQueue::Collect(std::vector<Event>& aOut) const
+	{
+		for (uint32_t level = 0; level < LevelCount; level++)
+		{
+			for (const Slot& slot : myLevels[level])
+				aOut.insert(aOut.end(), slot.myEvents.begin() + slot.myHead, slot.myEvents.end());
+		}
+	}
+
+	size_t TimingWheelEventQueue::OwnedBytes() const
+	{
+		size_t bytes = myCascadeScratch.capacity() * sizeof(Event);
+
+		for (const std::array<Slot, SlotCount>& level : myLevels)
+		{
+			for (const Slot& slot : level)
+				bytes += slot.myEvents.capacity() * sizeof(Event);
+		}
+
+		return bytes;
+	}
+
+	uint32_t TimingWheelEventQueue::LevelOf(uint64_t aTime) const
+	{
+		uint64_t differing = aTime ^ myCursor;
+
+		if (differing < SlotCount)
+			return 0;
+
+		return (std::bit_width(differing) - 1) / SlotBits;
+	}
+
+	int TimingWheelEventQueue::FirstOccupied(uint32_t aLevel) const
+	{
+		for (size_t word = 0; word < myOccupied[aLevel].size(); word++)
+		{
+			if (myOccupied[aLevel][word])
+				return static_cast<int>(word * 64 + std::countr_zero(myOccupied[aLevel][word]));
+		}
+
+		return -1;
+	}
+
+	int TimingWheelEventQueue::FrontSlot()
+	{
+		int index = FirstOccupied(0);
+
+		if (index >= 0)
+			return index;
+
+		for (uint32_t level = 1; level < LevelCount; level++)
+		{
+			int higher = FirstOccupied(level);
+			if (higher < 0)
+				continue;
+
+			Cascade(level, higher);
+			break;
+		}
+
+		return FirstOccupied(0);
+	}
+
+	void TimingWheelEventQueue::Cascade(uint32_t aLevel, uint32_t aSlot)
+	{
+		Slot& slot = myLevels[aLevel][aSlot];
+
+		myCursor = slot.myMinTime;
+		myCascadeScratch.swap(slot.myEvents);
+		Release(aLevel, aSlot);
+
+		mySize -= myCascadeScratch.size();
+		for (const Event& event : myCascadeScratch)
+			Push(event);
+
+		myCascadeScratch.clear();
+	}
+
+	void TimingWheelEventQueue::Release(uint32_t aLevel, uint32_t aSlot)
+	{
+		Slot& slot = myLevels[aLevel][aSlot];
+
+		slot.myEvents.clear();
+		slot.myHead = 0;
+		slot.myMinTime = UINT64_MAX;
+
+		myOccupied[aLevel][aSlot / 64] &= ~(uint64_t(1) << (aSlot % 64));
+	}
+	LayeredEventQueue::LayeredEventQueue(std::unique_ptr<EventQueue> aOwn)
+		: myOwn(std::move(aOwn))
+	{
+	}
+
+	EventQueue::Backend LayeredEventQueue::GetBackend() const
+	{
+		return myOwn->GetBackend();
+	}
+
+	void LayeredEventQueue::Push(const Event& aEvent)
+	{
+		myOwn->Push(aEvent);
+	}
+
+	void LayeredEventQueue::PushBatch(std::span<const Event> aEvents)
+	{
+		myOwn->PushBatch(aEvents);
+	}
+
+	Event LayeredEventQueue::Pop()
+	{
+		if (!SharedIsNext())
+			return myOwn->Pop();
+
+		Event event = (*myShared)[myNextShared++];
+
+		if (myNextShared == myShared->size())
+		{
+			myShared.reset();
+			myNextShared = 0;
+		}
+
+		return event;
+	}
+
+	const Event& LayeredEventQueue::Peek()
+	{
+		return SharedIsNext() ? (*myShared)[myNextShared] : myOwn->Peek();
+	}
+
+	bool LayeredEventQueue::Empty() const
+	{
+		return !myShared && myOwn->Empty();
+	}
+
+	size_t LayeredEventQueue::Size() const
+	{
+		return (myShared ? myShared->size() - myNextShared : 0) + myOwn->Size();
+	}
+
+	uint64_t LayeredEventQueue::NextTime() const
+	{
+		uint64_t own = myOwn->Empty() ? UINT64_MAX : myOwn->NextTime();
+
+		return myShared ? std::min((*myShared)[myNextShared].GetWhen(), own) : own;
+	}
+
+	void LayeredEventQueue::Clear(uint64_t aNow)
+	{
+		myShared.reset();
+		myNextShared = 0;
+		myOwn->Clear(aNow);
+	}
+
+	void LayeredEventQueue::Assign(const std::vector<Event>& aEvents, uint64_t aNow)
+	{
+		myShared.reset();
+		myNextShared = 0;
+		myOwn->Assign(aEvents, aNow);
+	}
+
+	void LayeredEventQueue::AssignShared(std::shared_ptr<const std::vector<Event>> aEvents, uint64_t aNow)
+	{
+		myOwn->Clear(aNow);
+		myShared = aEvents->empty() ? nullptr : std::move(aEvents);
+		myNextShared = 0;
+	}
+
+	void LayeredEventQueue::Collect(std::vector<Event>& aOut) const
+	{
+		if (myShared)
+			aOut.insert(aOut.end(), myShared->begin() + myNextShared, myShared->end());
+
+		myOwn->Collect(aOut);
+	}
+
+	size_t LayeredEventQueue::OwnedBytes() const
+	{
+		return myOwn->OwnedBytes();
+	}
+
+	bool LayeredEventQueue::SharedIsNext()
+	{
+		if (!myShared)
+			return false;
+
+		if (myOwn->Empty())
+			return true;
+
+		const Event& shared = (*myShared)[myNextShared];
+		uint64_t own = myOwn->NextTime();
+
+		if (shared.GetWhen() != own)
+			return shared.GetWhen() < own;
+
+		// Both are due on the tick being resolved, so the own queue can be asked for its front
+		return myOwn->Peek() < shared;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "TimelineEvent.h"
+
+namespace fisk
+{
+	class EventQueue
+	{
+	public:
+		enum class Backend
+		{
+			BinaryHeap,
+			TimingWheel
+		};
+
+		static std::unique_ptr<EventQueue> Create(Backend aBackend);
+
+		virtual ~EventQueue() = default;
+
+		virtual Backend GetBackend() const = 0;
+
+		virtual void Push(const Event& aEvent) = 0;
+		virtual void PushBatch(std::span<const Event> aEvents);
+		virtual Event Pop() = 0;
+
+		// The event Pop would return, only asked for once its tick is due
+		virtual const Event& Peek() = 0;
+
+		virtual bool Empty() const = 0;
+		virtual size_t Size() const = 0;
+		virtual uint64_t NextTime() const = 0;
+
+		virtual void Clear(uint64_t aNow) = 0;
+		virtual void Assign(const std::vector<Event>& aEvents, uint64_t aNow);
+		// aEvents are sorted earliest first and never change, queues that can read them in place keep them
+		virtual void AssignShared(std::shared_ptr<const std::vector<Event>> aEvents, uint64_t aNow);
+		virtual void Collect(std::vector<Event>& aOut) const = 0;
+
+		virtual size_t OwnedBytes() const = 0;
+	};
+
+	class HeapEventQueue : public EventQueue
+	{
+	public:
+		Backend GetBackend() const override;
+
+		void Push(const Event& aEvent) override;
+		void PushBatch(std::span<const Event> aEvents) override;
+		Event Pop() override;
+		const Event& Peek() override;
+
+		bool Empty() const override;
+		size_t Size() const override;
+		uint64_t NextTime() const override;
+
+		void Clear(uint64_t aNow) override;
+		void Assign(const std::vector<Event>& aEvents, uint64_t aNow) override;
+		void Collect(std::vector<Event>& aOut) const override;
+
+		size_t OwnedBytes() const override;
+
+	private:
+		std::vector<Event> myEvents;
+	};
+
+	class TimingWheelEventQueue : public EventQueue
+	{
+	public:
+		static constexpr uint32_t SlotBits = 8;
+		static constexpr uint32_t SlotCount = 1 << SlotBits;
+		static constexpr uint32_t LevelCount = 64 / SlotBits;
+
+		Backend GetBackend() const override;
+
+		void Push(const Event& aEvent) override;
+		Event Pop() override;
+		const Event& Peek() override;
+
+		bool Empty() const override;
+		size_t Size() const override;
+		uint64_t NextTime() const override;
+
+		void Clear(uint64_t aNow) override;
+		void Collect(std::vector<Event>& aOut) const override;
+
+		size_t OwnedBytes() const override;
+
+	private:
+		struct Slot
+		{
+			std::vector<Event> myEvents;
+			size_t myHead = 0;
+			uint64_t myMinTime = UINT64_MAX;
+		};
+
+		using Occupancy = std::array<uint64_t, SlotCount / 64>;
+
+		uint32_t LevelOf(uint64_t aTime) const;
+		int FirstOccupied(uint32_t aLevel) const;
+		int FrontSlot();
+		void Cascade(uint32_t aLevel, uint32_t aSlot);
+		void Release(uint32_t aLevel, uint32_t aSlot);
+
+		std::array<std::array<Slot, SlotCount>, LevelCount> myLevels;
+		std::array<Occupancy, LevelCount> myOccupied = {};
+		std::vector<Event> myCascadeScratch;
+
+		uint64_t myCursor = 0;
+		size_t mySize = 0;
+	};
+	// Queue of a forked timeline. The events it was forked with are read in place from the keyframe
+	// they were captured in, only what has been queued since goes into a queue of its own.
+	class LayeredEventQueue : public EventQueue
+	{
+	public:
+		LayeredEventQueue(std::unique_ptr<EventQueue> aOwn);
+
+		Backend GetBackend() const override;
+
+		void Push(const Event& aEvent) override;
+		void PushBatch(std::span<const Event> aEvents) override;
+		Event Pop() override;
+		const Event& Peek() override;
+
+		bool Empty() const override;
+		size_t Size() const override;
+		uint64_t NextTime() const override;
+
+		void Clear(uint64_t aNow) override;
+		void Assign(const std::vector<Event>& aEvents, uint64_t aNow) override;
+		void AssignShared(std::shared_ptr<const std::vector<Event>> aEvents, uint64_t aNow) override;
+		void Collect(std::vector<Event>& aOut) const override;
+
+		size_t OwnedBytes() const override;
+
+	private:
+		bool SharedIsNext();
+
+		std::unique_ptr<EventQueue> myOwn;
+		std::shared_ptr<const std::vector<Event>> myShared;
+		size_t myNextShared = 0;
+	};
+}
\ No newline at end of file
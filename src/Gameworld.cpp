@@ -17,10 +17,13 @@ namespace fisk
 		ImGui::Begin("Gameworld");
 
 		ImGui::Text("Time");
-		myTimeline.Advance();
-		myTimeline.ImguiDrawTimeline();
+		mySimulation.ImguiDrawTimeline();
 
 		ImGui::End();
+
+		ImGui::Begin("Branches");
+		mySimulation.ImguiDrawBranches();
+		ImGui::End();
 	}
 
 }
\ No newline at end of file
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "ImguiHelper.h"
-#include "Timeline.h"
+#include "SimulationThread.h"
 
 namespace fisk
 {
@@ -13,7 +13,7 @@ namespace fisk
 	private:
 		void Imgui();
 
-		Timeline myTimeline;
+		SimulationThread mySimulation;
 
 		tools::EventReg myImgui;
 	};
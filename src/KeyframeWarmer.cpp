@@ -0,0 +1,133 @@
+#include "KeyframeWarmer.h"
+
+#include <algorithm>
+#include <cassert>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace fisk
+{
+	namespace
+	{
+		void LowerThreadPriority()
+		{
+#if defined(_WIN32)
+			SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+			sched_param param = {};
+			pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+		}
+	}
+
+	KeyframeWarmer::KeyframeWarmer()
+	{
+		myThread = std::thread(&KeyframeWarmer::Run, this);
+	}
+
+	KeyframeWarmer::~KeyframeWarmer()
+	{
+		{
+			std::lock_guard lock(myMutex);
+			myStopping = true;
+		}
+
+		myCancelled.store(true, std::memory_order_relaxed);
+		myWake.notify_one();
+		myThread.join();
+	}
+
+	void KeyframeWarmer::Start(Timeline&& aFork, uint64_t aUntil)
+	{
+		assert(!Busy() && "Cancel the running job and wait for it to finish before starting another");
+
+		{
+			std::lock_guard lock(myMutex);
+			myJob.emplace(std::move(aFork));
+			myUntil = aUntil;
+			myHasResult = false;
+			myResult.clear();
+		}
+
+		myCancelled.store(false, std::memory_order_relaxed);
+		myBusy.store(true, std::memory_order_release);
+		myWake.notify_one();
+	}
+
+	void KeyframeWarmer::Cancel()
+	{
+		myCancelled.store(true, std::memory_order_relaxed);
+	}
+
+	bool KeyframeWarmer::Busy() const
+	{
+		return myBusy.load(std::memory_order_acquire);
+	}
+
+	bool KeyframeWarmer::TakeResult(std::vector<Keyframe>& aOut, uint64_t& aRevision)
+	{
+		std::lock_guard lock(myMutex);
+
+		if (!myHasResult)
+			return false;
+
+		aOut = std::move(myResult);
+		aRevision = myResultRevision;
+		myResult.clear();
+		myHasResult = false;
+
+		return true;
+	}
+
+	void KeyframeWarmer::Run()
+	{
+		LowerThreadPriority();
+
+		while (true)
+		{
+			std::unique_lock lock(myMutex);
+			myWake.wait(lock, [this]() { return myStopping || myJob.has_value(); });
+
+			if (myStopping)
+				return;
+
+			Timeline fork = std::move(*myJob);
+			uint64_t until = myUntil;
+			myJob.reset();
+			lock.unlock();
+
+			bool completed = Warm(fork, until);
+			std::vector<Keyframe> keyframes = completed ? fork.TakeKeyframes() : std::vector<Keyframe>();
+
+			lock.lock();
+
+			if (completed)
+			{
+				myResult = std::move(keyframes);
+				myResultRevision = fork.GetRevision();
+				myHasResult = true;
+			}
+
+			myBusy.store(false, std::memory_order_release);
+		}
+	}
+
+	bool KeyframeWarmer::Warm(Timeline& aFork, uint64_t aUntil)
+	{
+		while (aFork.GetTime() < aUntil)
+		{
+			if (myCancelled.load(std::memory_order_relaxed))
+				return false;
+
+			aFork.Seek(std::min(aFork.GetTime() + TicksPerCheck, aUntil));
+		}
+
+		return true;
+	}
+}
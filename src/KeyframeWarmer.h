@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "Timeline.h"
+
+namespace fisk
+{
+	// Simulates a forked timeline on a low priority thread so the keyframes it captures can be
+	// adopted by the original. Results are tagged with the revision the fork was taken at; the
+	// owner cancels the job as soon as its own history is edited.
+	class KeyframeWarmer
+	{
+	public:
+		static constexpr uint64_t TicksPerCheck = 16;
+
+		KeyframeWarmer();
+		~KeyframeWarmer();
+
+		KeyframeWarmer(const KeyframeWarmer&) = delete;
+		KeyframeWarmer& operator=(const KeyframeWarmer&) = delete;
+
+		void Start(Timeline&& aFork, uint64_t aUntil);
+		void Cancel();
+		bool Busy() const;
+
+		bool TakeResult(std::vector<Keyframe>& aOut, uint64_t& aRevision);
+
+	private:
+		void Run();
+		bool Warm(Timeline& aFork, uint64_t aUntil);
+
+		std::mutex myMutex;
+		std::condition_variable myWake;
+		std::optional<Timeline> myJob;
+		uint64_t myUntil = 0;
+
+		std::vector<Keyframe> myResult;
+		uint64_t myResultRevision = 0;
+		bool myHasResult = false;
+
+		std::atomic<bool> myBusy = false;
+		std::atomic<bool> myCancelled = false;
+		bool myStopping = false;
+		std::thread myThread;
+	};
+}
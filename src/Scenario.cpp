@@ -0,0 +1,239 @@
+#include "Scenario.h"
+
+#include <sstream>
+
+namespace fisk
+{
+	namespace
+	{
+		bool ParseTeam(const std::string& aWord, Team& aOut)
+		{
+			if (aWord == "friend")
+				aOut = Team::Friend;
+			else if (aWord == "foe")
+				aOut = Team::Foe;
+			else
+				return false;
+
+			return true;
+		}
+
+		bool ParseTargeting(const std::string& aWord, TargetingPolicy::Kind& aOut)
+		{
+			if (aWord == "first")
+				aOut = TargetingPolicy::Kind::First;
+			else if (aWord == "roundrobin")
+				aOut = TargetingPolicy::Kind::RoundRobin;
+			else if (aWord == "mostdamaged")
+				aOut = TargetingPolicy::Kind::MostDamaged;
+			else
+				return false;
+
+			return true;
+		}
+
+		bool ParseBackend(const std::string& aWord, EventQueue::Backend& aOut)
+		{
+			if (aWord == "heap")
+				aOut = EventQueue::Backend::BinaryHeap;
+			else if (aWord == "wheel")
+				aOut = EventQueue::Backend::TimingWheel;
+			else
+				return false;
+
+			return true;
+		}
+
+		bool ParseDamageResolution(const std::string& aWord, DamageResolution& aOut)
+		{
+			if (aWord == "immediate")
+				aOut = DamageResolution::Immediate;
+			else if (aWord == "simultaneous")
+				aOut = DamageResolution::Simultaneous;
+			else
+				return false;
+
+			return true;
+		}
+
+		uint64_t SolvePath(const std::array<int, arcospheres::Count>& aFrom)
+		{
+			arcospheres::State goal;
+			arcospheres::State from;
+
+			for (size_t i = 0; i < arcospheres::Count; i++)
+			{
+				goal.myCounts[i] = 5;
+				from.myCounts[i] = static_cast<uint8_t>(5 + aFrom[i]);
+			}
+
+			arcospheres::FuturePath path(from, goal);
+
+			while (!path.Done() && !path.Failed())
+				path.Step(1000);
+
+			return path.mySteps;
+		}
+	}
+
+	std::optional<Scenario> Scenario::Parse(std::istream& aStream, std::string& aError)
+	{
+		Scenario scenario;
+		std::string line;
+		size_t lineNumber = 0;
+
+		while (std::getline(aStream, line))
+		{
+			lineNumber++;
+
+			std::istringstream words(line);
+			std::string command;
+
+			if (!(words >> command) || command[0] == '#')
+				continue;
+
+			Step step;
+			step.myLine = lineNumber;
+
+			bool ok = true;
+			std::string word;
+
+			if (command == "spawn")
+			{
+				step.myCommand = Command::Spawn;
+				ok = (words >> step.myTick >> word >> step.myCount) && ParseTeam(word, step.myTeam);
+			}
+			else if (command == "advance")
+			{
+				step.myCommand = Command::Advance;
+				ok = static_cast<bool>(words >> step.myCount);
+			}
+			else if (command == "seek")
+			{
+				step.myCommand = Command::Seek;
+				ok = static_cast<bool>(words >> step.myTick);
+			}
+			else if (command == "rewind")
+			{
+				step.myCommand = Command::Rewind;
+				ok = static_cast<bool>(words >> step.myCount);
+			}
+			else if (command == "targeting")
+			{
+				step.myCommand = Command::Targeting;
+				ok = (words >> word) && ParseTargeting(word, step.myTargeting);
+			}
+			else if (command == "queue")
+			{
+				step.myCommand = Command::Queue;
+				ok = (words >> word) && ParseBackend(word, step.myBackend);
+			}
+			else if (command == "damage")
+			{
+				step.myCommand = Command::Damage;
+				ok = (words >> word) && ParseDamageResolution(word, step.myDamageResolution);
+			}
+			else if (command == "keyframes")
+			{
+				step.myCommand = Command::Keyframes;
+				ok = static_cast<bool>(words >> step.myTick >> step.myCount);
+			}
+			else if (command == "threads")
+			{
+				step.myCommand = Command::Threads;
+				ok = static_cast<bool>(words >> step.myCount);
+			}
+			else if (command == "path")
+			{
+				step.myCommand = Command::Path;
+
+				for (int& delta : step.myPathFrom)
+					ok = ok && (words >> delta) && delta >= -5 && delta <= 250;
+			}
+			else
+			{
+				aError = "line " + std::to_string(lineNumber) + ": unknown command '" + command + "'";
+				return {};
+			}
+
+			if (!ok)
+			{
+				aError = "line " + std::to_string(lineNumber) + ": bad arguments to '" + command + "'";
+				return {};
+			}
+
+			scenario.mySteps.push_back(step);
+		}
+
+		return scenario;
+	}
+
+	ScenarioStats Scenario::Run(Timeline& aTimeline) const
+	{
+		ScenarioStats stats;
+		uint64_t firstEvent = aTimeline.GetResolvedEvents();
+		uint64_t firstCancelled = aTimeline.GetCancelledEvents();
+
+		for (const Step& step : mySteps)
+		{
+			uint64_t now = aTimeline.GetTime();
+
+			switch (step.myCommand)
+			{
+			case Command::Spawn:
+			{
+				std::vector<Action> spawns;
+				spawns.reserve(step.myCount);
+
+				for (uint64_t i = 0; i < step.myCount; i++)
+					spawns.push_back(Action::Spawn(step.myTeam));
+
+				stats.myTicks += aTimeline.InsertActions(spawns, step.myTick);
+				break;
+			}
+			case Command::Advance:
+				aTimeline.Advance(step.myCount);
+
+				stats.myTicks += step.myCount;
+				break;
+			case Command::Seek:
+				aTimeline.Seek(step.myTick);
+
+				if (step.myTick > now)
+					stats.myTicks += step.myTick - now;
+				break;
+			case Command::Rewind:
+				aTimeline.Seek(now > step.myCount ? now - step.myCount : 0);
+				break;
+			case Command::Targeting:
+				aTimeline.SetTargeting(step.myTargeting);
+				break;
+			case Command::Queue:
+				aTimeline.SetQueueBackend(step.myBackend);
+				break;
+			case Command::Damage:
+				aTimeline.SetDamageResolution(step.myDamageResolution);
+				break;
+			case Command::Keyframes:
+				aTimeline.SetKeyframeIntervals(step.myTick, step.myCount);
+				break;
+			case Command::Threads:
+				aTimeline.SetParallelism(step.myCount);
+				break;
+			case Command::Path:
+				stats.myPathSteps += SolvePath(step.myPathFrom);
+				break;
+			}
+		}
+
+		stats.myEvents = aTimeline.GetResolvedEvents() - firstEvent;
+		stats.myCancelledEvents = aTimeline.GetCancelledEvents() - firstCancelled;
+
+		return stats;
+	}
+
+	const std::vector<Scenario::Step>& Scenario::GetSteps() const
+	{
+		return mySteps;
+	}
+}
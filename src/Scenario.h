@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Arcospheres.h"
+#include "Targeting.h"
+#include "Timeline.h"
+
+namespace fisk
+{
+	struct ScenarioStats
+	{
+		uint64_t myTicks = 0;
+		uint64_t myEvents = 0;
+		uint64_t myCancelledEvents = 0;
+		uint64_t myPathSteps = 0;
+	};
+
+	class Scenario
+	{
+	public:
+		enum class Command
+		{
+			Spawn,
+			Advance,
+			Seek,
+			Rewind,
+			Targeting,
+			Queue,
+			Damage,
+			Keyframes,
+			Threads,
+			Path
+		};
+
+		struct Step
+		{
+			Command myCommand;
+			uint64_t myTick = 0;
+			uint64_t myCount = 0;
+			Team myTeam = Team::Friend;
+			TargetingPolicy::Kind myTargeting = TargetingPolicy::Kind::First;
+			EventQueue::Backend myBackend = EventQueue::Backend::BinaryHeap;
+			DamageResolution myDamageResolution = DamageResolution::Immediate;
+			std::array<int, arcospheres::Count> myPathFrom = {};
+			size_t myLine = 0;
+		};
+
+		static std::optional<Scenario> Parse(std::istream& aStream, std::string& aError);
+
+		ScenarioStats Run(Timeline& aTimeline) const;
+
+		const std::vector<Step>& GetSteps() const;
+
+	private:
+		std::vector<Step> mySteps;
+	};
+}
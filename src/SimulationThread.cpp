@@ -0,0 +1,360 @@
+#include "SimulationThread.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <string>
+
+namespace fisk
+{
+	namespace
+	{
+		const SimulationThread::Clock::duration locPollInterval = std::chrono::milliseconds(2);
+		const SimulationThread::Clock::duration locMaxSpeedSlice = std::chrono::milliseconds(10);
+		const SimulationThread::Clock::duration locMeasureWindow = std::chrono::milliseconds(500);
+	}
+
+	SimulationCommand SimulationCommand::Spawn(Team aTeam, uint32_t aCount)
+	{
+		SimulationCommand command;
+		command.myKind = Kind::Spawn;
+		command.myTeam = aTeam;
+		command.myCount = aCount;
+		return command;
+	}
+
+	SimulationCommand SimulationCommand::Insert(Team aTeam, uint64_t aTick)
+	{
+		SimulationCommand command;
+		command.myKind = Kind::Insert;
+		command.myTeam = aTeam;
+		command.myTick = aTick;
+		return command;
+	}
+
+	SimulationCommand SimulationCommand::Seek(uint64_t aTick)
+	{
+		SimulationCommand command;
+		command.myKind = Kind::Seek;
+		command.myTick = aTick;
+		return command;
+	}
+
+	SimulationCommand SimulationCommand::Rewind(uint64_t aTicks)
+	{
+		SimulationCommand command;
+		command.myKind = Kind::Rewind;
+		command.myTick = aTicks;
+		return command;
+	}
+
+	SimulationCommand SimulationCommand::SetQueueBackend(EventQueue::Backend aBackend)
+	{
+		SimulationCommand command;
+		command.myKind = Kind::SetQueueBackend;
+		command.myBackend = aBackend;
+		return command;
+	}
+
+	SimulationCommand SimulationCommand::SetTargeting(TargetingPolicy::Kind aKind)
+	{
+		SimulationCommand command;
+		command.myKind = Kind::SetTargeting;
+		command.myTargeting = aKind;
+		return command;
+	}
+
+	SimulationCommand SimulationCommand::SetDamageResolution(DamageResolution aResolution)
+	{
+		SimulationCommand command;
+		command.myKind = Kind::SetDamageResolution;
+		command.myDamageResolution = aResolution;
+		return command;
+	}
+
+	SimulationCommand SimulationCommand::SetTickRate(uint32_t aTicksPerSecond)
+	{
+		SimulationCommand command;
+		command.myKind = Kind::SetTickRate;
+		command.myCount = aTicksPerSecond;
+		return command;
+	}
+
+	SimulationCommand SimulationCommand::SetSpeed(uint32_t aMultiplier)
+	{
+		SimulationCommand command;
+		command.myKind = Kind::SetSpeed;
+		command.myCount = aMultiplier;
+		return command;
+	}
+
+	SimulationCommand SimulationCommand::Branch(Team aTeam, uint64_t aTick, uint32_t aCount)
+	{
+		SimulationCommand command;
+		command.myKind = Kind::Branch;
+		command.myTeam = aTeam;
+		command.myTick = aTick;
+		command.myCount = aCount;
+		return command;
+	}
+
+	SimulationCommand SimulationCommand::ClearBranches()
+	{
+		SimulationCommand command;
+		command.myKind = Kind::ClearBranches;
+		return command;
+	}
+
+	SimulationThread::SimulationThread(uint32_t aTicksPerSecond)
+		: myTickRate(std::max(aTicksPerSecond, 1u))
+		, myBranches(std::max(std::thread::hardware_concurrency(), 2u) - 1)
+	{
+		myThread = std::thread(&SimulationThread::Run, this);
+	}
+
+	SimulationThread::~SimulationThread()
+	{
+		myStopping.store(true, std::memory_order_relaxed);
+		myThread.join();
+	}
+
+	bool SimulationThread::Send(const SimulationCommand& aCommand)
+	{
+		return myCommands.Push(aCommand);
+	}
+
+	const WorldSnapshot& SimulationThread::Read()
+	{
+		return mySnapshots.Front();
+	}
+
+	uint32_t SimulationThread::GetTickRate() const
+	{
+		return myTickRate.load(std::memory_order_relaxed);
+	}
+
+	uint64_t SimulationThread::GetDroppedTicks() const
+	{
+		return myDroppedTicks.load(std::memory_order_relaxed);
+	}
+
+	uint32_t SimulationThread::GetSpeed() const
+	{
+		return mySpeed.load(std::memory_order_relaxed);
+	}
+
+	uint64_t SimulationThread::GetMeasuredTickRate() const
+	{
+		return myMeasuredTickRate.load(std::memory_order_relaxed);
+	}
+
+	uint64_t SimulationThread::GetWarmedKeyframes() const
+	{
+		return myWarmedKeyframes.load(std::memory_order_relaxed);
+	}
+
+	void SimulationThread::Run()
+	{
+		Publish();
+
+		Clock::time_point next = Clock::now();
+		myMeasureStart = next;
+
+		while (!myStopping.load(std::memory_order_relaxed))
+		{
+			bool changed = ApplyCommands();
+
+			uint64_t ticks = Step(next);
+			Measure(ticks);
+
+			changed = WarmKeyframes() || changed;
+
+			if (changed || ticks > 0)
+				Publish();
+
+			std::this_thread::sleep_until(std::min(next, Clock::now() + locPollInterval));
+		}
+	}
+
+	uint64_t SimulationThread::Step(Clock::time_point& aNext)
+	{
+		Clock::time_point now = Clock::now();
+		uint32_t speed = GetSpeed();
+
+		if (speed == MaxSpeed)
+		{
+			// Run flat out for a slice of wall time, then come back up for commands and a publish
+			uint64_t ticks = 0;
+
+			do
+			{
+				myTimeline.Advance(MaxSpeedBatch);
+				ticks += MaxSpeedBatch;
+			} while (Clock::now() - now < locMaxSpeedSlice);
+
+			aNext = Clock::now();
+			return ticks;
+		}
+
+		Clock::duration step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / GetTickRate()));
+		uint32_t steps = 0;
+
+		while (aNext <= now && steps < MaxCatchUpTicks)
+		{
+			myTimeline.Advance(speed);
+			aNext += step;
+			steps++;
+		}
+
+		if (aNext <= now)
+		{
+			myDroppedTicks.fetch_add((static_cast<uint64_t>((now - aNext) / step) + 1) * speed, std::memory_order_relaxed);
+			aNext = now + step;
+		}
+
+		return static_cast<uint64_t>(steps) * speed;
+	}
+
+	void SimulationThread::Measure(uint64_t aTicks)
+	{
+		myMeasuredTicks += aTicks;
+
+		Clock::time_point now = Clock::now();
+		Clock::duration elapsed = now - myMeasureStart;
+
+		if (elapsed < locMeasureWindow)
+			return;
+
+		myMeasuredTickRate.store(static_cast<uint64_t>(static_cast<double>(myMeasuredTicks) / std::chrono::duration<double>(elapsed).count()), std::memory_order_relaxed);
+		myMeasuredTicks = 0;
+		myMeasureStart = now;
+	}
+
+	bool SimulationThread::ApplyCommands()
+	{
+		SimulationCommand command;
+		bool any = false;
+
+		while (myCommands.Pop(command))
+		{
+			Apply(command);
+			any = true;
+		}
+
+		return any;
+	}
+
+	void SimulationThread::Apply(const SimulationCommand& aCommand)
+	{
+		uint64_t now = myTimeline.GetTime();
+
+		switch (aCommand.myKind)
+		{
+		case SimulationCommand::Kind::Spawn:
+			myTimeline.SpawnWave(aCommand.myTeam, aCommand.myCount);
+			break;
+		case SimulationCommand::Kind::Insert:
+			myTimeline.InsertAction(Action::Spawn(aCommand.myTeam), aCommand.myTick);
+			break;
+		case SimulationCommand::Kind::Seek:
+			myTimeline.Seek(aCommand.myTick);
+			break;
+		case SimulationCommand::Kind::Rewind:
+			myTimeline.Seek(now > aCommand.myTick ? now - aCommand.myTick : 0);
+			break;
+		case SimulationCommand::Kind::SetQueueBackend:
+			myTimeline.SetQueueBackend(aCommand.myBackend);
+			break;
+		case SimulationCommand::Kind::SetTargeting:
+			myTimeline.SetTargeting(aCommand.myTargeting);
+			break;
+		case SimulationCommand::Kind::SetDamageResolution:
+			myTimeline.SetDamageResolution(aCommand.myDamageResolution);
+			break;
+		case SimulationCommand::Kind::SetTickRate:
+			assert(aCommand.myCount > 0);
+			myTickRate.store(std::max(aCommand.myCount, 1u), std::memory_order_relaxed);
+			break;
+		case SimulationCommand::Kind::SetSpeed:
+			mySpeed.store(aCommand.myCount, std::memory_order_relaxed);
+			break;
+		case SimulationCommand::Kind::Branch:
+			AddBranch(aCommand.myTeam, aCommand.myTick, aCommand.myCount);
+			break;
+		case SimulationCommand::Kind::ClearBranches:
+			myBranches.Clear();
+			break;
+		}
+	}
+
+	void SimulationThread::AddBranch(Team aTeam, uint64_t aTick, uint32_t aCount)
+	{
+		uint64_t until = aTick + BranchTicks;
+
+		// The first what-if of a comparison is measured against the timeline left as it is
+		if (myBranches.Count() == 0)
+			myBranches.Add("Baseline", myTimeline.Fork(aTick, UINT64_MAX, UINT64_MAX), until);
+
+		Timeline branch = myTimeline.Fork(aTick, UINT64_MAX, UINT64_MAX);
+
+		std::vector<Action> spawns;
+		spawns.reserve(aCount);
+
+		for (uint32_t i = 0; i < aCount; i++)
+			spawns.push_back(Action::Spawn(aTeam));
+
+		branch.InsertActions(spawns, aTick);
+
+		std::string label = "+" + std::to_string(aCount) + (aTeam == Team::Friend ? " friends" : " foes") + " at " + std::to_string(aTick);
+		myBranches.Add(std::move(label), std::move(branch), until);
+	}
+
+	bool SimulationThread::WarmKeyframes()
+	{
+		uint64_t revision = myTimeline.GetRevision();
+
+		if (myWarmer.Busy())
+		{
+			if (revision != myWarmRevision)
+				myWarmer.Cancel();
+
+			return false;
+		}
+
+		bool adopted = false;
+		std::vector<Keyframe> keyframes;
+		uint64_t warmedAt;
+
+		if (myWarmer.TakeResult(keyframes, warmedAt))
+		{
+			size_t count = myTimeline.AdoptKeyframes(std::move(keyframes), warmedAt);
+			myWarmedKeyframes.fetch_add(count, std::memory_order_relaxed);
+			adopted = count > 0;
+		}
+
+		uint64_t now = myTimeline.GetTime();
+		uint64_t moved = now > myWarmAround ? now - myWarmAround : myWarmAround - now;
+
+		if (revision == myWarmRevision && moved < WarmBehindTicks / 2)
+			return adopted;
+
+		uint64_t from = now > WarmBehindTicks ? now - WarmBehindTicks : 0;
+		uint64_t until = std::min(now + WarmAheadTicks, std::max(myTimeline.GetMaxTime(), now));
+
+		myWarmRevision = revision;
+		myWarmAround = now;
+
+		// Warmed keyframes sit on a tick grid, capture by event count would only crowd busy stretches. The
+		// fork starts on a keyframe so that all of the simulating happens on the warmer's thread.
+		if (until > from)
+			myWarmer.Start(myTimeline.Fork(myTimeline.GetKeyframeTime(from), WarmKeyframeInterval, UINT64_MAX), until);
+
+		return adopted;
+	}
+
+	void SimulationThread::Publish()
+	{
+		myTimeline.Capture(mySnapshots.Back());
+		mySnapshots.Publish();
+	}
+}
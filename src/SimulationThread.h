@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "BranchRunner.h"
+#include "KeyframeWarmer.h"
+#include "SpscQueue.h"
+#include "Timeline.h"
+#include "TripleBuffer.h"
+
+namespace fisk
+{
+	struct SimulationCommand
+	{
+		enum class Kind : uint8_t
+		{
+			Spawn,
+			Insert,
+			Seek,
+			Rewind,
+			SetQueueBackend,
+			SetTargeting,
+			SetDamageResolution,
+			SetTickRate,
+			SetSpeed,
+			Branch,
+			ClearBranches
+		};
+
+		static SimulationCommand Spawn(Team aTeam, uint32_t aCount);
+		static SimulationCommand Insert(Team aTeam, uint64_t aTick);
+		static SimulationCommand Seek(uint64_t aTick);
+		static SimulationCommand Rewind(uint64_t aTicks);
+		static SimulationCommand SetQueueBackend(EventQueue::Backend aBackend);
+		static SimulationCommand SetTargeting(TargetingPolicy::Kind aKind);
+		static SimulationCommand SetDamageResolution(DamageResolution aResolution);
+		static SimulationCommand SetTickRate(uint32_t aTicksPerSecond);
+		static SimulationCommand SetSpeed(uint32_t aMultiplier);
+		static SimulationCommand Branch(Team aTeam, uint64_t aTick, uint32_t aCount);
+		static SimulationCommand ClearBranches();
+
+		Kind myKind = Kind::Seek;
+		Team myTeam = Team::Friend;
+		EventQueue::Backend myBackend = EventQueue::Backend::BinaryHeap;
+		TargetingPolicy::Kind myTargeting = TargetingPolicy::Kind::First;
+		DamageResolution myDamageResolution = DamageResolution::Immediate;
+		uint32_t myCount = 0;
+		uint64_t myTick = 0;
+	};
+
+	// Owns a Timeline and advances it at a fixed tick rate on its own thread. Other threads never
+	// touch the timeline: they send commands through Send and read the last published snapshot.
+	class SimulationThread
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		static constexpr uint32_t MaxCatchUpTicks = 8;
+		static constexpr uint32_t MaxSpeed = 0;
+		static constexpr uint64_t MaxSpeedBatch = 256;
+		static constexpr uint64_t WarmBehindTicks = 2000;
+		static constexpr uint64_t WarmAheadTicks = 2000;
+		static constexpr uint64_t WarmKeyframeInterval = 100;
+		static constexpr uint64_t BranchTicks = 5000;
+
+		SimulationThread(uint32_t aTicksPerSecond = 60);
+		~SimulationThread();
+
+		SimulationThread(const SimulationThread&) = delete;
+		SimulationThread& operator=(const SimulationThread&) = delete;
+
+		bool Send(const SimulationCommand& aCommand);
+		const WorldSnapshot& Read();
+
+		uint32_t GetTickRate() const;
+		uint64_t GetDroppedTicks() const;
+		uint32_t GetSpeed() const;
+		uint64_t GetMeasuredTickRate() const;
+		uint64_t GetWarmedKeyframes() const;
+
+		void ImguiDrawTimeline();
+		void ImguiDrawBranches();
+
+	private:
+		void Run();
+		bool ApplyCommands();
+		void Apply(const SimulationCommand& aCommand);
+		uint64_t Step(Clock::time_point& aNext);
+		void Measure(uint64_t aTicks);
+		bool WarmKeyframes();
+		void AddBranch(Team aTeam, uint64_t aTick, uint32_t aCount);
+		void Publish();
+
+		Timeline myTimeline;
+
+		SpscQueue<SimulationCommand, 256> myCommands;
+		TripleBuffer<WorldSnapshot> mySnapshots;
+
+		std::atomic<uint32_t> myTickRate;
+		std::atomic<uint64_t> myDroppedTicks = 0;
+		std::atomic<uint32_t> mySpeed = 1;
+		std::atomic<uint64_t> myMeasuredTickRate = 0;
+		std::atomic<uint64_t> myWarmedKeyframes = 0;
+		std::atomic<bool> myStopping = false;
+
+		KeyframeWarmer myWarmer;
+		uint64_t myWarmRevision = UINT64_MAX;
+		uint64_t myWarmAround = 0;
+
+		BranchRunner myBranches;
+		std::vector<BranchView> myBranchViews;
+
+		Clock::time_point myMeasureStart;
+		uint64_t myMeasuredTicks = 0;
+
+		std::thread myThread;
+	};
+}
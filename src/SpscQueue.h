@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace fisk
+{
+	// Bounded ring for a single producer and a single consumer. Push fails instead of blocking
+	// when the consumer has fallen a full ring behind.
+	template<class Type, size_t Capacity>
+	class SpscQueue
+	{
+		static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	public:
+		bool Push(const Type& aValue)
+		{
+			size_t tail = myTail.load(std::memory_order_relaxed);
+
+			if (tail - myHead.load(std::memory_order_acquire) == Capacity)
+				return false;
+
+			mySlots[tail & (Capacity - 1)] = aValue;
+			myTail.store(tail + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		bool Pop(Type& aOut)
+		{
+			size_t head = myHead.load(std::memory_order_relaxed);
+
+			if (head == myTail.load(std::memory_order_acquire))
+				return false;
+
+			aOut = mySlots[head & (Capacity - 1)];
+			myHead.store(head + 1, std::memory_order_release);
+
+			return true;
+		}
+
+	private:
+		std::array<Type, Capacity> mySlots;
+
+		alignas(64) std::atomic<size_t> myHead = 0;
+		alignas(64) std::atomic<size_t> myTail = 0;
+	};
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "tools/MathVector.h"
+
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <vector>
+
+namespace fisk
+{
+	struct StlMesh
+	{
+		std::vector<tools::V4f> myPositions;
+		std::vector<uint32_t> myIndexes;
+	};
+
+	void DeduplicateVertexes(std::vector<tools::V4f>& aVertex, std::vector<uint32_t>& aOutIndex);
+
+	std::optional<StlMesh> MeshFromAsciiStl(std::istream& aStream);
+	std::optional<StlMesh> MeshFromBinaryStl(std::istream& aStream);
+}
@@ -0,0 +1,311 @@
+#include "Targeting.h"
+#include "Zobrist.h"
+
+namespace fisk
+{
+	namespace
+	{
+		Team EnemyOf(Team aTeam)
+		{
+			return aTeam == Team::Friend ? Team::Foe : Team::Friend;
+		}
+	}
+
+	void TeamIndex::Add(UnitHandle aUnit, Team aTeam)
+	{
+		if (aUnit.myIndex >= myMemberPositions.Size())
+		{
+			myMemberPositions.Resize(aUnit.myIndex + 1, UnitStore::Vacant);
+			myDamagePositions.Resize(aUnit.myIndex + 1, UnitStore::Vacant);
+		}
+
+		Insert(MembersOf(aTeam), myMemberPositions, aUnit);
+		Insert(DamageBucket(aTeam, 0), myDamagePositions, aUnit);
+	}
+
+	void TeamIndex::Remove(UnitHandle aUnit, Team aTeam, int aDamage)
+	{
+		Erase(MembersOf(aTeam), myMemberPositions, aUnit);
+		Erase(DamageBucket(aTeam, aDamage), myDamagePositions, aUnit);
+	}
+
+	void TeamIndex::Damaged(UnitHandle aUnit, Team aTeam, int aFrom, int aTo)
+	{
+		Erase(DamageBucket(aTeam, aFrom), myDamagePositions, aUnit);
+		Insert(DamageBucket(aTeam, aTo), myDamagePositions, aUnit);
+	}
+
+	void TeamIndex::Clear()
+	{
+		for (Bucket& members : myMembers)
+			members.Clear();
+
+		for (std::array<Bucket, UnitStore::Health>& buckets : myByDamage)
+		{
+			for (Bucket& bucket : buckets)
+				bucket.Clear();
+		}
+
+		myMemberPositions.Clear();
+		myDamagePositions.Clear();
+		myRoundRobin = {};
+		myHash = 0;
+	}
+
+	uint32_t TeamIndex::MemberPosition(UnitHandle aUnit) const
+	{
+		return myMemberPositions[aUnit.myIndex];
+	}
+
+	uint32_t TeamIndex::DamagePosition(UnitHandle aUnit) const
+	{
+		return myDamagePositions[aUnit.myIndex];
+	}
+
+	void TeamIndex::UndoAdd(UnitHandle aUnit, Team aTeam)
+	{
+		Remove(aUnit, aTeam, 0);
+	}
+
+	void TeamIndex::UndoRemove(UnitHandle aUnit, Team aTeam, int aDamage, uint32_t aMemberPosition, uint32_t aDamagePosition)
+	{
+		Reinsert(MembersOf(aTeam), myMemberPositions, aUnit, aMemberPosition);
+		Reinsert(DamageBucket(aTeam, aDamage), myDamagePositions, aUnit, aDamagePosition);
+	}
+
+	void TeamIndex::UndoDamaged(UnitHandle aUnit, Team aTeam, int aFrom, int aTo, uint32_t aDamagePosition)
+	{
+		Erase(DamageBucket(aTeam, aTo), myDamagePositions, aUnit);
+		Reinsert(DamageBucket(aTeam, aFrom), myDamagePositions, aUnit, aDamagePosition);
+	}
+
+	const TeamIndex::Bucket& TeamIndex::Members(Team aTeam) const
+	{
+		return myMembers[static_cast<size_t>(aTeam)];
+	}
+
+	const TeamIndex::Bucket& TeamIndex::WithDamage(Team aTeam, int aDamage) const
+	{
+		return myByDamage[static_cast<size_t>(aTeam)][aDamage];
+	}
+
+	uint32_t& TeamIndex::RoundRobinCursor(Team aTeam)
+	{
+		return myRoundRobin[static_cast<size_t>(aTeam)];
+	}
+
+	uint32_t TeamIndex::RoundRobinCursor(Team aTeam) const
+	{
+		return myRoundRobin[static_cast<size_t>(aTeam)];
+	}
+
+	size_t TeamIndex::Bytes() const
+	{
+		size_t bytes = myMemberPositions.Bytes() + myDamagePositions.Bytes();
+
+		for (const Bucket& members : myMembers)
+			bytes += members.Bytes();
+
+		for (const std::array<Bucket, UnitStore::Health>& buckets : myByDamage)
+		{
+			for (const Bucket& bucket : buckets)
+				bytes += bucket.Bytes();
+		}
+
+		return bytes;
+	}
+
+	size_t TeamIndex::OwnedBytes() const
+	{
+		size_t bytes = myMemberPositions.OwnedBytes() + myDamagePositions.OwnedBytes();
+
+		for (const Bucket& members : myMembers)
+			bytes += members.OwnedBytes();
+
+		for (const std::array<Bucket, UnitStore::Health>& buckets : myByDamage)
+		{
+			for (const Bucket& bucket : buckets)
+				bytes += bucket.OwnedBytes();
+		}
+
+		return bytes;
+	}
+
+	uint64_t TeamIndex::Hash() const
+	{
+		uint64_t hash = myHash;
+
+		for (size_t team = 0; team < TeamCount; team++)
+			hash ^= ZobristKey(team, myRoundRobin[team]);
+
+		return hash;
+	}
+
+	TeamIndex::Bucket& TeamIndex::MembersOf(Team aTeam)
+	{
+		return myMembers[static_cast<size_t>(aTeam)];
+	}
+
+	TeamIndex::Bucket& TeamIndex::DamageBucket(Team aTeam, int aDamage)
+	{
+		return myByDamage[static_cast<size_t>(aTeam)][aDamage];
+	}
+
+	void TeamIndex::Insert(Bucket& aBucket, ChunkedColumn<uint32_t>& aPositions, UnitHandle aUnit)
+	{
+		aPositions.Mutable(aUnit.myIndex) = static_cast<uint32_t>(aBucket.Size());
+		aBucket.Push(aUnit);
+
+		myHash ^= KeyOf(aBucket, aPositions[aUnit.myIndex]);
+	}
+
+	void TeamIndex::Erase(Bucket& aBucket, ChunkedColumn<uint32_t>& aPositions, UnitHandle aUnit)
+	{
+		uint32_t position = aPositions[aUnit.myIndex];
+		uint32_t last = static_cast<uint32_t>(aBucket.Size() - 1);
+
+		myHash ^= KeyOf(aBucket, position);
+
+		if (position != last)
+		{
+			myHash ^= KeyOf(aBucket, last);
+
+			aBucket.Mutable(position) = aBucket.Back();
+			aPositions.Mutable(aBucket[position].myIndex) = position;
+
+			myHash ^= KeyOf(aBucket, position);
+		}
+
+		aBucket.Pop();
+		aPositions.Mutable(aUnit.myIndex) = UnitStore::Vacant;
+	}
+
+	void TeamIndex::Reinsert(Bucket& aBucket, ChunkedColumn<uint32_t>& aPositions, UnitHandle aUnit, uint32_t aPosition)
+	{
+		if (aPosition == aBucket.Size())
+		{
+			Insert(aBucket, aPositions, aUnit);
+			return;
+		}
+
+		// Mirror of Erase: whoever was swapped into the hole goes back to the end
+		uint32_t last = static_cast<uint32_t>(aBucket.Size());
+
+		myHash ^= KeyOf(aBucket, aPosition);
+
+		aBucket.Push(aBucket[aPosition]);
+		aPositions.Mutable(aBucket[last].myIndex) = last;
+
+		myHash ^= KeyOf(aBucket, last);
+
+		aBucket.Mutable(aPosition) = aUnit;
+		aPositions.Mutable(aUnit.myIndex) = aPosition;
+
+		myHash ^= KeyOf(aBucket, aPosition);
+	}
+
+	uint64_t TeamIndex::KeyOf(const Bucket& aBucket, uint32_t aPosition) const
+	{
+		return ZobristKey(reinterpret_cast<uintptr_t>(&aBucket) - reinterpret_cast<uintptr_t>(this), aPosition, aBucket[aPosition].myGeneration);
+	}
+
+	std::unique_ptr<TargetingPolicy> TargetingPolicy::Create(Kind aKind)
+	{
+		switch (aKind)
+		{
+		case Kind::First:
+			return std::make_unique<FirstTargeting>();
+		case Kind::RoundRobin:
+			return std::make_unique<RoundRobinTargeting>();
+		case Kind::MostDamaged:
+			return std::make_unique<MostDamagedTargeting>();
+		}
+		return nullptr;
+	}
+
+	void TargetingPolicy::Skip(TeamIndex&, Team, uint32_t) const
+	{
+	}
+
+	TargetingPolicy::Kind FirstTargeting::GetKind() const
+	{
+		return Kind::First;
+	}
+
+	UnitHandle FirstTargeting::Select(TeamIndex& aIndex, Team aAttacker) const
+	{
+		return SelectNth(aIndex, aAttacker, 0);
+	}
+
+	UnitHandle FirstTargeting::SelectNth(const TeamIndex& aIndex, Team aAttacker, uint32_t) const
+	{
+		const TeamIndex::Bucket& enemies = aIndex.Members(EnemyOf(aAttacker));
+
+		if (enemies.Empty())
+			return UnitHandle();
+
+		return enemies[0];
+	}
+
+	TargetingPolicy::Kind RoundRobinTargeting::GetKind() const
+	{
+		return Kind::RoundRobin;
+	}
+
+	UnitHandle RoundRobinTargeting::Select(TeamIndex& aIndex, Team aAttacker) const
+	{
+		const TeamIndex::Bucket& enemies = aIndex.Members(EnemyOf(aAttacker));
+
+		if (enemies.Empty())
+			return UnitHandle();
+
+		uint32_t& cursor = aIndex.RoundRobinCursor(aAttacker);
+		cursor = (cursor + 1) % enemies.Size();
+
+		return enemies[cursor];
+	}
+
+	UnitHandle RoundRobinTargeting::SelectNth(const TeamIndex& aIndex, Team aAttacker, uint32_t aNth) const
+	{
+		const TeamIndex::Bucket& enemies = aIndex.Members(EnemyOf(aAttacker));
+
+		if (enemies.Empty())
+			return UnitHandle();
+
+		return enemies[(uint64_t(aIndex.RoundRobinCursor(aAttacker)) + 1 + aNth) % enemies.Size()];
+	}
+
+	void RoundRobinTargeting::Skip(TeamIndex& aIndex, Team aAttacker, uint32_t aCount) const
+	{
+		const TeamIndex::Bucket& enemies = aIndex.Members(EnemyOf(aAttacker));
+
+		if (enemies.Empty())
+			return;
+
+		uint32_t& cursor = aIndex.RoundRobinCursor(aAttacker);
+		cursor = static_cast<uint32_t>((uint64_t(cursor) + aCount) % enemies.Size());
+	}
+
+	TargetingPolicy::Kind MostDamagedTargeting::GetKind() const
+	{
+		return Kind::MostDamaged;
+	}
+
+	UnitHandle MostDamagedTargeting::Select(TeamIndex& aIndex, Team aAttacker) const
+	{
+		return SelectNth(aIndex, aAttacker, 0);
+	}
+
+	UnitHandle MostDamagedTargeting::SelectNth(const TeamIndex& aIndex, Team aAttacker, uint32_t) const
+	{
+		for (int damage = UnitStore::Health - 1; damage >= 0; damage--)
+		{
+			const TeamIndex::Bucket& enemies = aIndex.WithDamage(EnemyOf(aAttacker), damage);
+
+			if (!enemies.Empty())
+				return enemies[0];
+		}
+
+		return UnitHandle();
+	}
+}
\ No newline at end of file
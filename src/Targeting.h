@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <memory>
+
+#include "ChunkedColumn.h"
+#include "UnitStore.h"
+
+namespace fisk
+{
+	// Live units of each team, also bucketed by damage taken. Copies share chunks like UnitStore does.
+	class TeamIndex
+	{
+	public:
+		using Bucket = ChunkedColumn<UnitHandle>;
+
+		void Add(UnitHandle aUnit, Team aTeam);
+		void Remove(UnitHandle aUnit, Team aTeam, int aDamage);
+		void Damaged(UnitHandle aUnit, Team aTeam, int aFrom, int aTo);
+		void Clear();
+
+		uint32_t MemberPosition(UnitHandle aUnit) const;
+		uint32_t DamagePosition(UnitHandle aUnit) const;
+
+		void UndoAdd(UnitHandle aUnit, Team aTeam);
+		void UndoRemove(UnitHandle aUnit, Team aTeam, int aDamage, uint32_t aMemberPosition, uint32_t aDamagePosition);
+		void UndoDamaged(UnitHandle aUnit, Team aTeam, int aFrom, int aTo, uint32_t aDamagePosition);
+
+		const Bucket& Members(Team aTeam) const;
+		const Bucket& WithDamage(Team aTeam, int aDamage) const;
+
+		uint32_t& RoundRobinCursor(Team aTeam);
+		uint32_t RoundRobinCursor(Team aTeam) const;
+
+		size_t Bytes() const;
+		size_t OwnedBytes() const;
+		uint64_t Hash() const;
+
+	private:
+		Bucket& MembersOf(Team aTeam);
+		Bucket& DamageBucket(Team aTeam, int aDamage);
+
+		void Insert(Bucket& aBucket, ChunkedColumn<uint32_t>& aPositions, UnitHandle aUnit);
+		void Erase(Bucket& aBucket, ChunkedColumn<uint32_t>& aPositions, UnitHandle aUnit);
+		void Reinsert(Bucket& aBucket, ChunkedColumn<uint32_t>& aPositions, UnitHandle aUnit, uint32_t aPosition);
+		uint64_t KeyOf(const Bucket& aBucket, uint32_t aPosition) const;
+
+		std::array<Bucket, TeamCount> myMembers;
+		std::array<std::array<Bucket, UnitStore::Health>, TeamCount> myByDamage;
+
+		ChunkedColumn<uint32_t> myMemberPositions;
+		ChunkedColumn<uint32_t> myDamagePositions;
+
+		std::array<uint32_t, TeamCount> myRoundRobin = {};
+
+		uint64_t myHash = 0;
+	};
+
+	class TargetingPolicy
+	{
+	public:
+		enum class Kind
+		{
+			First,
+			RoundRobin,
+			MostDamaged
+		};
+
+		static std::unique_ptr<TargetingPolicy> Create(Kind aKind);
+
+		virtual ~TargetingPolicy() = default;
+
+		virtual Kind GetKind() const = 0;
+		virtual UnitHandle Select(TeamIndex& aIndex, Team aAttacker) const = 0;
+
+		// What the aNth next Select for aAttacker would return if the index did not change in between.
+		// Leaves the index alone, so a batch of attacks against a frozen index can pick in any order.
+		virtual UnitHandle SelectNth(const TeamIndex& aIndex, Team aAttacker, uint32_t aNth) const = 0;
+
+		// Leaves the index as aCount calls to Select would have
+		virtual void Skip(TeamIndex& aIndex, Team aAttacker, uint32_t aCount) const;
+	};
+
+	class FirstTargeting : public TargetingPolicy
+	{
+	public:
+		Kind GetKind() const override;
+		UnitHandle Select(TeamIndex& aIndex, Team aAttacker) const override;
+		UnitHandle SelectNth(const TeamIndex& aIndex, Team aAttacker, uint32_t aNth) const override;
+	};
+
+	class RoundRobinTargeting : public TargetingPolicy
+	{
+	public:
+		Kind GetKind() const override;
+		UnitHandle Select(TeamIndex& aIndex, Team aAttacker) const override;
+		UnitHandle SelectNth(const TeamIndex& aIndex, Team aAttacker, uint32_t aNth) const override;
+		void Skip(TeamIndex& aIndex, Team aAttacker, uint32_t aCount) const override;
+	};
+
+	class MostDamagedTargeting : public TargetingPolicy
+	{
+	public:
+		Kind GetKind() const override;
+		UnitHandle Select(TeamIndex& aIndex, Team aAttacker) const override;
+		UnitHandle SelectNth(const TeamIndex& aIndex, Team aAttacker, uint32_t aNth) const override;
+	};
+}
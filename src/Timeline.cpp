@@ -1,17 +1,40 @@
 #include "Timeline.h"
-#include "imgui/imgui.h"
 #include <algorithm>
+#include <cassert>
 
 namespace fisk
 {
-	Action::Action(uint64_t aAt)
+	Action::Action(Kind aKind, Team aTeam, uint8_t aNameId)
+		: myKind(aKind)
+		, myTeam(aTeam)
+		, myNameId(aNameId)
 	{
-		myAt = aAt;
 	}
 
-	uint64_t Action::GetWhen()
+	Action Action::Spawn(Team aTeam)
+	{
+		return Action(Kind::Spawn, aTeam, UnitStore::NextNameId());
+	}
+
+	Action::Kind Action::GetKind() const
+	{
+		return myKind;
+	}
+
+	void Action::Resolve(Timeline& aTimeline, uint32_t aIndex) const
+	{
+		switch (myKind)
+		{
+		case Kind::Spawn:
+			aTimeline.AddUnit(myTeam, myNameId, aIndex);
+			break;
+		}
+	}
+
+	Timeline::Timeline()
+		: myEvents(EventQueue::Create(EventQueue::Backend::BinaryHeap))
+		, myTargeting(TargetingPolicy::Create(TargetingPolicy::Kind::First))
 	{
-		return myAt;
 	}
 
 	uint64_t Timeline::GetTime(uint64_t aOffset)
@@ -19,163 +42,619 @@ namespace fisk
 		return myNow + aOffset;
 	}
 
-	void Timeline::ImguiDrawTimeline()
+	uint64_t Timeline::GetMaxTime()
 	{
+		return myMaxTime;
+	}
 
-		ImDrawList* drawlist = ImGui::GetWindowDrawList();
-		float width = 500;
+	void Timeline::Advance(uint64_t aTicks)
+	{
+		myMaxTime += aTicks;
+		Goto(myNow + aTicks);
+	}
 
-		ImVec2 topleft = ImGui::GetCursorScreenPos();
+	void Timeline::Seek(uint64_t aTime)
+	{
+		const Keyframe* keyframe = FindKeyframe(aTime);
 
-		auto getX = [&](uint64_t aTime)
+		if (aTime < myNow)
 		{
-			return topleft.x + static_cast<float>(aTime) / static_cast<float>(myMaxTime) * width;
-		};
+			if (Rewind(aTime))
+			{
+				Goto(aTime);
+				return;
+			}
 
-		auto poi = [&](uint64_t aTime, const char* aName, float aImportance, ImColor aColor = ImColor(200, 200, 200))
+			if (keyframe)
+				RestoreKeyframe(*keyframe);
+			else
+				Reset();
+		}
+		else if (keyframe && keyframe->myTime > myNow)
 		{
-			float x = getX(aTime);
-			drawlist->AddLine(ImVec2(x, topleft.y), ImVec2(x, topleft.y + aImportance), aColor);
-			drawlist->AddText(ImVec2(x, topleft.y + aImportance), aColor, aName);
-		};
+			RestoreKeyframe(*keyframe);
+		}
 
-		drawlist->AddLine(topleft, ImVec2(topleft.x + width, topleft.y), ImColor(255, 255, 255));
+		Goto(aTime);
+	}
 
-		poi(myNow, "Now", 40);
+	void Timeline::SpawnFriend()
+	{
+		InsertAction(Action::Spawn(Team::Friend), myNow);
+	}
 
-		for (Action* act : myActions)
+	void Timeline::SpawnFoe()
+	{
+		InsertAction(Action::Spawn(Team::Foe), myNow);
+	}
+
+	void Timeline::SpawnWave(Team aTeam, size_t aCount)
+	{
+		std::vector<Action> spawns;
+		spawns.reserve(aCount);
+
+		for (size_t i = 0; i < aCount; i++)
+			spawns.push_back(Action::Spawn(aTeam));
+
+		InsertActions(spawns, myNow);
+	}
+
+	uint64_t Timeline::InsertAction(Action aAction, uint64_t aTick)
+	{
+		return InsertActions(std::span<const Action>(&aAction, 1), aTick);
+	}
+
+	uint64_t Timeline::InsertActions(std::span<const Action> aActions, uint64_t aTick)
+	{
+		uint32_t first = static_cast<uint32_t>(myActions.Size());
+		myRevision++;
+
+		for (const Action& action : aActions)
+			myActions.Push(ScheduledAction{ aTick, action });
+
+		if (aTick >= myUnresolvedFrom)
 		{
-			poi(act->GetWhen(), "S", 20, ImColor(255, 100, 70, 128));
+			InvalidateKeyframesAfter(aTick);
+
+			for (uint32_t i = first; i < myActions.Size(); i++)
+				QueueAction(i);
+
+			if (aTick <= myNow)
+				Goto(myNow);
+
+			myLastResimulation = Resimulation{ 0, myNow };
+			return 0;
 		}
 
-		for (Event e : myEvents)
+		uint64_t now = myNow;
+
+		if (myConvergenceTracking)
+			BeginConvergence(aTick);
+		else
+			InvalidateKeyframesAfter(aTick);
+
+		const Keyframe* keyframe = FindKeyframe(aTick);
+
+		if (keyframe)
+			RestoreKeyframe(*keyframe);
+		else
+			Reset();
+
+		myLastResimulation = Resimulation{ now - myNow, now, 0 };
+
+		Goto(now);
+		myConvergence.reset();
+
+		return myLastResimulation.myTicks;
+	}
+
+	void Timeline::ResolveAction(uint32_t aIndex)
+	{
+		myActions[aIndex].myAction.Resolve(*this, aIndex);
+	}
+
+	Resimulation Timeline::GetLastResimulation()
+	{
+		return myLastResimulation;
+	}
+
+	uint64_t Timeline::GetTicksSavedByConvergence()
+	{
+		return myTicksSavedByConvergence;
+	}
+
+	UnitHandle Timeline::AddUnit(Team aTeam, uint8_t aNameId, uint32_t aGeneration)
+	{
+		uint32_t previous = myUnits.NextGeneration();
+		UnitHandle unit = myUnits.Create(aTeam, aNameId, aGeneration);
+		myTeams.Add(unit, aTeam);
+
+		myUndo.Changed(UnitChange{ UnitChange::Kind::Spawn, aTeam, aNameId, false, unit, previous });
+
+		StartTimer(TimerCall::Attack, unit, AttackPeriod, myNow % AttackPeriod);
+		Attack(unit);
+
+		return unit;
+	}
+
+	void Timeline::Attack(UnitHandle aUnit)
+	{
+		if (!myUnits.IsAlive(aUnit) || myUnits.IsDead(aUnit))
+			return;
+
+		Team team = myUnits.GetTeam(aUnit);
+		uint32_t cursor = myTeams.RoundRobinCursor(team);
+
+		UnitHandle target = myTargeting->Select(myTeams, team);
+
+		if (myTeams.RoundRobinCursor(team) != cursor)
+			myUndo.Changed(UnitChange{ UnitChange::Kind::Retarget, team, 0, false, aUnit, cursor });
+
+		if (myUnits.IsAlive(target))
+			Damage(target, 1);
+	}
+
+	void Timeline::Damage(UnitHandle aUnit, int aAmount)
+	{
+		if (myUnits.IsDead(aUnit))
+			return;
+
+		if (myDamageResolution == DamageResolution::Simultaneous)
+			myDamageBuffer.Add(aUnit, aAmount);
+		else
+			ApplyDamage(aUnit, aAmount);
+	}
+
+	void Timeline::ApplyDamage(UnitHandle aUnit, int aAmount)
+	{
+		int before = myUnits.GetDamage(aUnit);
+		Team team = myUnits.GetTeam(aUnit);
+
+		UnitChange change{ UnitChange::Kind::Damage, team, 0, false, aUnit, static_cast<uint32_t>(before), aAmount, myTeams.MemberPosition(aUnit), myTeams.DamagePosition(aUnit) };
+
+		myUnits.AddDamage(aUnit, aAmount);
+
+		if (myUnits.IsDead(aUnit))
+		{
+			change.myKilled = true;
+			myTombstones++;
+			myTeams.Remove(aUnit, team, before);
+			QueueEvent(Event::RemoveUnit(myNow, aUnit));
+		}
+		else
 		{
-			poi(e.GetWhen(), "e", 10);
+			myTeams.Damaged(aUnit, team, before, myUnits.GetDamage(aUnit));
 		}
 
+		myUndo.Changed(change);
+	}
 
-		ImGui::Dummy(ImVec2(width, 50));
-		int32_t target_time = myNow;
-		if (ImGui::SliderInt("##target_time", &target_time, 0, myMaxTime, "", ImGuiSliderFlags_AlwaysClamp))
+	void Timeline::ApplyBufferedDamage()
+	{
+		// Hits on units that have gone, or were already dying, since they were dealt don't land
+		myDamageBuffer.Discard([this](UnitHandle aUnit)
 		{
-			Reset();
-			Goto(target_time);
+			return !myUnits.IsAlive(aUnit) || myUnits.IsDead(aUnit);
+		});
+
+		myUnits.AddDamage(myDamageBuffer.Amounts());
+
+		myDying.clear();
+
+		for (UnitHandle unit : myDamageBuffer.Units())
+		{
+			if (myUnits.IsDead(unit))
+				myDying.push_back(unit);
 		}
-		ImGui::Separator();
 
-		if (ImGui::Button("Go back"))
+		// The team index, the undo log and the removal events catch up with the whole tick at once, in
+		// the order the units were first hit
+		for (UnitHandle unit : myDamageBuffer.Units())
 		{
-			uint64_t target = 0;
+			int amount = myDamageBuffer.AmountOf(unit);
+			int after = myUnits.GetDamage(unit);
+			int before = after - amount;
+			Team team = myUnits.GetTeam(unit);
+			bool killed = after >= UnitStore::Health;
 
-			if (myNow > 600)
-			{
-				target = myNow - 600;
-			}
-			Reset();
-			Goto(target);
+			myUndo.Changed(UnitChange{ UnitChange::Kind::Damage, team, 0, killed, unit, static_cast<uint32_t>(before), amount, myTeams.MemberPosition(unit), myTeams.DamagePosition(unit) });
+
+			if (killed)
+				myTeams.Remove(unit, team, before);
+			else
+				myTeams.Damaged(unit, team, before, after);
 		}
 
-		if (ImGui::Button("Spawn Friend"))
-			SpawnFriend();
-		if (ImGui::Button("Spawn Foe"))
-			SpawnFoe();
+		myTombstones += myDying.size();
 
-		ImGui::Separator();
+		for (UnitHandle unit : myDying)
+			QueueEvent(Event::RemoveUnit(myNow, unit));
 
-		ImGui::Text("Units");
+		myDamageBuffer.Clear();
+		FlushPendingEvents();
+	}
 
-		for (std::shared_ptr<Unit> unit : myUnits)
-		{
-			switch (unit->myTeam)
-			{
-			case Unit::Team::Foe:
-				ImGui::PushStyleColor(ImGuiCol_Button, ImColor(255, 100, 100).Value);
-				ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImColor(255, 120, 120).Value);
-				ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImColor(255, 150, 150).Value);
-				break;
-			}
+	void Timeline::RemoveUnit(UnitHandle aUnit)
+	{
+		if (myUnits.IsAlive(aUnit))
+			myUndo.Changed(UnitChange{ UnitChange::Kind::Remove, myUnits.GetTeam(aUnit), myUnits.GetNameId(aUnit), false, aUnit, static_cast<uint32_t>(myUnits.GetDamage(aUnit)), 0, myUnits.DenseIndexOf(aUnit) });
 
+		myUnits.Destroy(aUnit);
+	}
 
-			ImGui::Button(unit->myName.c_str());
-			ImGui::SameLine();
+	void Timeline::StartTimer(TimerCall aCall, UnitHandle aOwner, uint32_t aPeriod, uint64_t aPhase)
+	{
+		assert(aPeriod > 0);
 
-			ImGui::PushStyleColor(ImGuiCol_ScrollbarGrab, ImColor(100, 255, 150).Value);
-			ImGui::ProgressBar(unit->GetHealthPercent());
-			ImGui::PopStyleColor(1);
+		uint64_t next = myNow + 1;
+		uint64_t first = next + (aPhase % aPeriod + aPeriod - next % aPeriod) % aPeriod;
 
-			switch (unit->myTeam)
-			{
-			case Unit::Team::Foe:
-				ImGui::PopStyleColor(3);
-				break;
-			}
-		}
+		QueueEvent(Event::Timer(first, aCall, aOwner, aPeriod));
 	}
 
-	void Timeline::Advance()
+	void Timeline::SetParallelism(size_t aThreads)
 	{
-		myMaxTime++;
-		Goto(myNow + 1);
+		if (aThreads <= 1)
+			myPool.reset();
+		else if (!myPool || myPool->GetThreadCount() != aThreads)
+			myPool = std::make_unique<WorkerPool>(aThreads);
 	}
 
-	void Timeline::SpawnFriend()
+	ParallelStats Timeline::GetParallelStats()
 	{
-		Action* spawn = new SpawnAction(myNow, *this, Unit::Team::Friend);
-		myActions.push_back(spawn);
+		return myParallelStats;
+	}
 
-		QueueEvent(spawn->AsEvent());
+	uint64_t Timeline::GetStateHash()
+	{
+		return WorldHash() ^ myEventHash;
 	}
 
-	void Timeline::SpawnFoe()
+	void Timeline::FireTimer(const Event& aTimer)
+	{
+		if (RunTimer(aTimer.GetTimerCall(), aTimer.GetOwner()))
+			QueueEvent(aTimer.Rearmed());
+	}
+
+	void Timeline::QueueAction(uint32_t aIndex)
+	{
+		Event event = Event::ForAction(myActions[aIndex].myAt, aIndex);
+		event.SetSequence(aIndex);
+
+		myEventsToAdd.push_back(event);
+	}
+
+	void Timeline::QueueEvent(Event aEvent)
+	{
+		assert(myNow < UINT32_MAX && "Sequence numbers are keyed on the tick they were queued on");
+
+		myNextSequence = std::max(myNextSequence, (myNow + 1) * FirstDynamicSequence);
+		aEvent.SetSequence(myNextSequence++);
+		myEventsToAdd.push_back(aEvent);
+	}
+
+	void Timeline::QueueEvents(std::span<const Event> aEvents)
+	{
+		assert(myNow < UINT32_MAX && "Sequence numbers are keyed on the tick they were queued on");
+
+		size_t first = myEventsToAdd.size();
+		myEventsToAdd.insert(myEventsToAdd.end(), aEvents.begin(), aEvents.end());
+
+		myNextSequence = std::max(myNextSequence, (myNow + 1) * FirstDynamicSequence);
+
+		for (size_t i = first; i < myEventsToAdd.size(); i++)
+			myEventsToAdd[i].SetSequence(myNextSequence++);
+	}
+
+	void Timeline::SetQueueBackend(EventQueue::Backend aBackend)
+	{
+		if (aBackend == myEvents->GetBackend())
+			return;
+
+		std::vector<Event> pending;
+		myEvents->Collect(pending);
+
+		myEvents = EventQueue::Create(aBackend);
+		myEvents->Assign(pending, myNow);
+	}
+
+	void Timeline::SetTargeting(TargetingPolicy::Kind aKind)
+	{
+		if (aKind == myTargeting->GetKind())
+			return;
+
+		myTargeting = TargetingPolicy::Create(aKind);
+		myRevision++;
+
+		uint64_t now = myNow;
+		InvalidateKeyframesAfter(0);
+		Reset();
+		Goto(now);
+	}
+
+	void Timeline::SetDamageResolution(DamageResolution aResolution)
+	{
+		if (aResolution == myDamageResolution)
+			return;
+
+		myDamageResolution = aResolution;
+		myRevision++;
+
+		uint64_t now = myNow;
+		InvalidateKeyframesAfter(0);
+		Reset();
+		Goto(now);
+	}
+
+	void Timeline::SetKeyframeIntervals(uint64_t aTicks, uint64_t aEvents)
 	{
-		Action* spawn = new SpawnAction(myNow, *this, Unit::Team::Foe);
-		myActions.push_back(spawn);
+		myKeyframeTickInterval = aTicks;
+		myKeyframeEventInterval = aEvents;
+	}
+
+	void Timeline::SetConvergenceTracking(bool aEnabled)
+	{
+		myConvergenceTracking = aEnabled;
+
+		if (!aEnabled)
+			myTickHashes.clear();
+	}
+
+	void Timeline::SetUndoCapacity(size_t aEvents, size_t aChanges)
+	{
+		myUndo = UndoLog(aEvents, aChanges);
+		myUndo.Clear(myUnresolvedFrom);
+	}
+
+	uint64_t Timeline::GetResolvedEvents()
+	{
+		return myResolvedEvents;
+	}
+
+	uint64_t Timeline::GetCancelledEvents()
+	{
+		return myCancelledEvents;
+	}
+
+	uint64_t Timeline::GetRevision()
+	{
+		return myRevision;
+	}
+
+	size_t Timeline::GetKeyframeBytes()
+	{
+		return myKeyframeBytes;
+	}
+
+	uint64_t Timeline::GetKeyframeTime(uint64_t aTime)
+	{
+		const Keyframe* keyframe = FindKeyframe(aTime);
+
+		return keyframe ? keyframe->myTime : 0;
+	}
 
-		QueueEvent(spawn->AsEvent());
+	size_t Timeline::GetOwnedBytes()
+	{
+		return myUnits.OwnedBytes()
+			+ myTeams.OwnedBytes()
+			+ myEvents->OwnedBytes()
+			+ myActions.OwnedBytes()
+			+ myKeyframeBytes;
 	}
 
-	void Timeline::AddUnit(std::shared_ptr<Unit> aUnit)
+	Timeline Timeline::Fork(uint64_t aTime, uint64_t aKeyframeTicks, uint64_t aKeyframeEvents)
 	{
-		myUnits.push_back(aUnit);
-		myEventHandles.push_back(aUnit->OnDeath.Register(
-			[this, aUnit]()
+		Timeline fork;
+
+		fork.myActions = myActions;
+		fork.myEvents = std::make_unique<LayeredEventQueue>(EventQueue::Create(myEvents->GetBackend()));
+		fork.myTargeting = TargetingPolicy::Create(myTargeting->GetKind());
+		fork.myDamageResolution = myDamageResolution;
+		fork.myMaxTime = myMaxTime;
+		fork.myRevision = myRevision;
+		fork.myKeyframeTickInterval = aKeyframeTicks;
+		fork.myKeyframeEventInterval = aKeyframeEvents;
+		fork.myKeyframeBudget = myKeyframeBudget;
+		fork.myConvergenceTracking = false;
+		fork.myUndo = UndoLog(0, 0);
+
+		if (Keyframe* keyframe = FindKeyframe(aTime))
 		{
-			QueueEvent(Event(myNow, [this, aUnit]()
+			if (!keyframe->myEventsSorted)
 			{
-				myUnits.erase(std::find(myUnits.begin(), myUnits.end(), aUnit));
-			}));
-		}));
+				std::vector<Event> events = *keyframe->myEvents;
+				std::sort(events.begin(), events.end(), [](const Event& aLeft, const Event& aRight)
+				{
+					return aRight < aLeft;
+				});
 
-		aUnit->OnSpawned(*this);
+				keyframe->myEvents = std::make_shared<const std::vector<Event>>(std::move(events));
+				keyframe->myEventsSorted = true;
+			}
+
+			fork.RestoreKeyframe(*keyframe);
+		}
+		else
+		{
+			fork.Reset();
+		}
+
+		fork.Goto(aTime);
+
+		return fork;
 	}
 
-	void Timeline::QueueEvent(Event aEvent)
+	std::vector<Keyframe> Timeline::TakeKeyframes()
 	{
-		myEventsToAdd.push_back(aEvent);
+		myKeyframeBytes = 0;
+
+		return std::move(myKeyframes);
 	}
 
-	std::vector<std::shared_ptr<Unit>>& Timeline::GetUnits()
+	size_t Timeline::AdoptKeyframes(std::vector<Keyframe>&& aKeyframes, uint64_t aRevision)
+	{
+		if (aRevision != myRevision)
+			return 0;
+
+		auto byTime = [](const Keyframe& aLeft, const Keyframe& aRight)
+		{
+			return aLeft.myTime < aRight.myTime;
+		};
+
+		auto distance = [this](const Keyframe& aKeyframe)
+		{
+			return aKeyframe.myTime > myNow ? aKeyframe.myTime - myNow : myNow - aKeyframe.myTime;
+		};
+
+		std::sort(aKeyframes.begin(), aKeyframes.end(), [&](const Keyframe& aLeft, const Keyframe& aRight)
+		{
+			return distance(aLeft) < distance(aRight);
+		});
+
+		size_t existing = myKeyframes.size();
+
+		for (Keyframe& keyframe : aKeyframes)
+		{
+			if (keyframe.myTime > myMaxTime)
+				continue;
+
+			if (myKeyframeBytes + keyframe.Bytes() > myKeyframeBudget)
+				break;
+
+			if (std::binary_search(myKeyframes.begin(), myKeyframes.begin() + existing, keyframe, byTime))
+				continue;
+
+			myKeyframeBytes += keyframe.Bytes();
+			myKeyframes.push_back(std::move(keyframe));
+		}
+
+		size_t adopted = myKeyframes.size() - existing;
+
+		std::sort(myKeyframes.begin() + existing, myKeyframes.end(), byTime);
+		std::inplace_merge(myKeyframes.begin(), myKeyframes.begin() + existing, myKeyframes.end(), byTime);
+
+		return adopted;
+	}
+
+	const UnitStore& Timeline::GetUnits()
 	{
 		return myUnits;
 	}
 
+	void Timeline::Capture(WorldSnapshot& aOut)
+	{
+		aOut.myTime = myNow;
+		aOut.myMaxTime = myMaxTime;
+
+		aOut.myActionTimes.clear();
+		for (size_t i = 0; i < myActions.Size(); i++)
+			aOut.myActionTimes.push_back(myActions[i].myAt);
+
+		aOut.myEvents.clear();
+		myEvents->Collect(aOut.myEvents);
+
+		aOut.myKeyframeTimes.clear();
+		for (const Keyframe& keyframe : myKeyframes)
+			aOut.myKeyframeTimes.push_back(keyframe.myTime);
+
+		aOut.myUnits.clear();
+		myUnits.ForEach([&](UnitHandle aUnit)
+		{
+			aOut.myUnits.push_back(UnitView{ aUnit.myIndex, myUnits.GetTeam(aUnit), myUnits.GetNameId(aUnit), myUnits.GetHealthPercent(aUnit) });
+		});
+
+		aOut.myLastResimulation = myLastResimulation;
+		aOut.myTicksSavedByConvergence = myTicksSavedByConvergence;
+		aOut.myResolvedEvents = myResolvedEvents;
+		aOut.myCancelledEvents = myCancelledEvents;
+		aOut.myCompactedEvents = myCompactedEvents;
+		aOut.myKeyframeBytes = myKeyframeBytes;
+		aOut.myKeyframeBudget = myKeyframeBudget;
+		aOut.myUndoEvents = myUndo.Size();
+		aOut.myUndoBytes = myUndo.Bytes();
+		aOut.myUndoFrom = myUndo.Oldest();
+
+		aOut.myBackend = myEvents->GetBackend();
+		aOut.myTargeting = myTargeting->GetKind();
+		aOut.myDamageResolution = myDamageResolution;
+	}
+
 
 	void Timeline::Goto(uint64_t aTime)
 	{
 		FlushPendingEvents();
 
-		while (!myEvents.empty())
+		while (!myEvents->Empty())
 		{
-			if (myEvents[0].GetWhen() > aTime)
+			uint64_t when = myEvents->NextTime();
+			if (when > aTime)
 				break;
 
-			myNow = myEvents[0].GetWhen();
+			if (when >= myUnresolvedFrom && myConvergenceTracking)
+			{
+				if (myConvergence && HasConverged(when))
+				{
+					Splice(when);
+					return;
+				}
+
+				RecordTickHash(when);
+			}
+
+			uint64_t lastKeyframe = myKeyframes.empty() ? 0 : myKeyframes.back().myTime;
+
+			if (when > lastKeyframe && (when - lastKeyframe >= myKeyframeTickInterval || myEventsSinceKeyframe >= myKeyframeEventInterval))
+				CaptureKeyframe(when);
+
+			myNow = when;
+			myUnresolvedFrom = when + 1;
+
+			// Drain the whole tick, including events it queues for itself, before looking at the clock again.
+			// Timers due together are collected and fired as one group, and buffered damage lands once
+			// nothing else is left in the tick.
+			while (true)
+			{
+				if (myEvents->Empty() || myEvents->NextTime() != when)
+				{
+					if (!myTimerBatch.empty())
+						FireTimers();
+					else if (!myDamageBuffer.Empty())
+						ApplyBufferedDamage();
+					else
+						break;
+
+					continue;
+				}
 
-			myEvents[0].Resolve();
-			std::pop_heap(myEvents.begin(), myEvents.end());
-			myEvents.pop_back();
+				myEventsSinceKeyframe++;
 
-			FlushPendingEvents();
+				Event event = myEvents->Pop();
+				myUndo.Resolved(ResolvedEvent{ event, when, myNextSequence, myEventHash, myTombstones, 0 });
+				myEventHash ^= event.Hash();
+
+				if (IsCancelled(event))
+				{
+					myCancelledEvents++;
+					myTombstones -= std::min<size_t>(myTombstones, 1);
+					continue;
+				}
+
+				if (event.GetKind() == Event::Kind::Timer)
+				{
+					myTimerBatch.push_back(event);
+					continue;
+				}
+
+				FireTimers();
+
+				myResolvedEvents++;
+				event.Resolve(*this);
+
+				FlushPendingEvents();
+			}
+
+			if (myTombstones >= MinTombstonesToCompact && myTombstones * TombstoneShareToCompact >= myEvents->Size())
+				CompactEvents();
 		}
 
 		myNow = aTime;
@@ -183,132 +662,474 @@ namespace fisk
 
 	void Timeline::FlushPendingEvents()
 	{
-		for (Event e : myEventsToAdd)
-		{
-			myEvents.push_back(e);
-			std::push_heap(myEvents.begin(), myEvents.end());
-		}
+		if (myEventsToAdd.empty())
+			return;
+
+		for (const Event& event : myEventsToAdd)
+			myEventHash ^= event.Hash();
+
+		if (myEventsToAdd.size() == 1)
+			myEvents->Push(myEventsToAdd[0]);
+		else
+			myEvents->PushBatch(myEventsToAdd);
+
 		myEventsToAdd.clear();
 	}
 
-	void Timeline::Reset()
+	bool Timeline::IsCancelled(const Event& aEvent)
 	{
-		myUnits.clear();
-		myEvents.clear();
-		myEventHandles.clear();
-		myNow = 0;
+		UnitHandle owner = aEvent.GetOwner();
+
+		if (owner == UnitHandle())
+			return false;
+
+		return !myUnits.IsAlive(owner) || myUnits.IsDead(owner);
+	}
 
-		for (Action* act : myActions)
-			myEvents.push_back(act->AsEvent());
+	void Timeline::FireTimers()
+	{
+		if (myTimerBatch.empty())
+			return;
+
+		if (myPool && myTimerBatch.size() >= MinParallelBatch)
+		{
+			if (myDamageResolution == DamageResolution::Simultaneous)
+			{
+				FireTimersFrozen();
+				return;
+			}
 
-		std::make_heap(myEvents.begin(), myEvents.end());
+			myParallelStats.mySerialBatches++;
+		}
+
+		for (size_t i = 0; i < myTimerBatch.size(); i++)
+		{
+			const Event& timer = myTimerBatch[i];
+
+			// An earlier timer in the group may have killed this one's owner
+			if (IsCancelled(timer))
+			{
+				myCancelledEvents++;
+				myTombstones -= std::min<size_t>(myTombstones, 1);
+				continue;
+			}
+
+			myResolvedEvents++;
+
+			if (RunTimer(timer.GetTimerCall(), timer.GetOwner()))
+				QueueEvent(timer.Rearmed());
+		}
+
+		myTimerBatch.clear();
+
+		FlushPendingEvents();
 	}
 
+	void Timeline::FireTimersFrozen()
+	{
+		myParallelStats.myBatches++;
+		myIntents.resize(myTimerBatch.size());
+
+		// Hits only land once the tick has drained, so every timer of the batch sees the world as the
+		// tick found it and nothing it reads changes until the batch is done. Timers that go on are
+		// swapped for the timer they re-arm as.
+		myPool->ParallelFor(myTimerBatch.size(), [this](size_t aIndex)
+		{
+			Event& timer = myTimerBatch[aIndex];
+			AttackIntent& intent = myIntents[aIndex];
+
+			intent.myCancelled = IsCancelled(timer);
+			intent.myAttacks = !intent.myCancelled && timer.GetTimerCall() == TimerCall::Attack;
+
+			if (intent.myAttacks)
+				intent.myTeam = myUnits.GetTeam(timer.GetOwner());
+
+			if (!intent.myCancelled)
+				timer = timer.Rearmed();
+		});
+
+		// Policies that keep a cursor need to know how many attacks of the team came first
+		std::array<uint32_t, TeamCount> attacks = {};
+
+		for (AttackIntent& intent : myIntents)
+		{
+			if (intent.myAttacks)
+				intent.myNth = attacks[static_cast<size_t>(intent.myTeam)]++;
+		}
+
+		myPool->ParallelFor(myTimerBatch.size(), [this](size_t aIndex)
+		{
+			AttackIntent& intent = myIntents[aIndex];
+
+			if (!intent.myAttacks)
+				return;
+
+			intent.myTarget = myTargeting->SelectNth(myTeams, intent.myTeam, intent.myNth);
+			intent.myHits = myUnits.IsAlive(intent.myTarget) && !myUnits.IsDead(intent.myTarget);
+		});
+
+		// Merged in batch order so the damage buffer and the sequence numbers come out as they would serially
+		for (size_t i = 0; i < myTimerBatch.size(); i++)
+		{
+			const AttackIntent& intent = myIntents[i];
+
+			if (intent.myCancelled)
+			{
+				myCancelledEvents++;
+				myTombstones -= std::min<size_t>(myTombstones, 1);
+				continue;
+			}
+
+			myResolvedEvents++;
+
+			if (intent.myAttacks)
+			{
+				myParallelStats.myAttacks++;
+
+				if (intent.myHits)
+					myDamageBuffer.Add(intent.myTarget, 1);
+			}
+
+			QueueEvent(myTimerBatch[i]);
+		}
+
+		for (size_t team = 0; team < TeamCount; team++)
+		{
+			if (attacks[team] == 0)
+				continue;
+
+			uint32_t cursor = myTeams.RoundRobinCursor(static_cast<Team>(team));
+			myTargeting->Skip(myTeams, static_cast<Team>(team), attacks[team]);
+
+			if (myTeams.RoundRobinCursor(static_cast<Team>(team)) != cursor)
+				myUndo.Changed(UnitChange{ UnitChange::Kind::Retarget, static_cast<Team>(team), 0, false, UnitHandle(), cursor });
+		}
+
+		myTimerBatch.clear();
+
+		FlushPendingEvents();
+	}
 
-	Event::Event(uint64_t aAt, std::function<void()> aCallback)
+	bool Timeline::RunTimer(TimerCall aCall, UnitHandle aOwner)
 	{
-		myAt = aAt;
-		myCallback = aCallback;
+		switch (aCall)
+		{
+		case TimerCall::Attack:
+			if (!myUnits.IsAlive(aOwner))
+				return false;
+
+			Attack(aOwner);
+			return true;
+		}
+
+		return false;
 	}
 
-	bool Event::operator<(const Event& aOther) const
+	void Timeline::CompactEvents()
 	{
-		return aOther.myAt < myAt;
+		myEventScratch.clear();
+		myEvents->Collect(myEventScratch);
+
+		auto cancelled = std::partition(myEventScratch.begin(), myEventScratch.end(), [this](const Event& aEvent)
+		{
+			return !IsCancelled(aEvent);
+		});
+
+		for (auto it = cancelled; it != myEventScratch.end(); ++it)
+		{
+			myUndo.Resolved(ResolvedEvent{ *it, myNow, myNextSequence, myEventHash, myTombstones, 0 });
+			myEventHash ^= it->Hash();
+		}
+
+		myCompactedEvents += std::distance(cancelled, myEventScratch.end());
+		myTombstones = 0;
+
+		myEventScratch.erase(cancelled, myEventScratch.end());
+		myEvents->Assign(myEventScratch, myNow);
 	}
 
-	uint64_t Event::GetWhen()
+	void Timeline::Reset()
 	{
-		return myAt;
+		myUnits.Clear();
+		myTeams.Clear();
+		myEvents->Clear(0);
+		myEventsToAdd.clear();
+		myNextSequence = FirstDynamicSequence;
+		myEventHash = 0;
+		myTickHashes.clear();
+		myNow = 0;
+		myUnresolvedFrom = 0;
+		myTombstones = 0;
+		myUndo.Clear(0);
+
+		for (uint32_t i = 0; i < myActions.Size(); i++)
+			QueueAction(i);
+
+		FlushPendingEvents();
 	}
 
-	void Event::Resolve()
+	void Timeline::Snapshot(Keyframe& aOut, uint64_t aTime)
 	{
-		myCallback();
+		std::vector<Event> events;
+		myEvents->Collect(events);
+
+		aOut.myTime = aTime;
+		aOut.myEvents = std::make_shared<const std::vector<Event>>(std::move(events));
+		aOut.myEventsSorted = false;
+		aOut.myUnits = myUnits;
+		aOut.myTeams = myTeams;
+		aOut.myNextSequence = myNextSequence;
+		aOut.myEventHash = myEventHash;
+		aOut.myTombstones = myTombstones;
+		aOut.myActionCount = myActions.Size();
 	}
 
-	Unit::Unit(Team aTeam)
+	void Timeline::CaptureKeyframe(uint64_t aTime)
 	{
-		static int counter = 0;
-		const char* names[] = {
-			"Bob",
-			"Alice",
-			"Tamara",
-			"Pogo",
-			"Tammy",
-			"Benny",
-			"Job",
-			"Craig"
-		};
+		Keyframe& keyframe = myKeyframes.emplace_back();
+		Snapshot(keyframe, aTime);
 
-		myName = names[counter++ % (sizeof(names) / sizeof(*names))];
-		myTeam = aTeam;
+		myKeyframeBytes += keyframe.Bytes();
+		myEventsSinceKeyframe = 0;
+
+		EnforceKeyframeBudget();
 	}
 
-	void Unit::OnSpawned(Timeline& aTimeline)
+	void Timeline::RestoreKeyframe(const Keyframe& aKeyframe)
 	{
-		Attack(aTimeline);
+		myEventsToAdd.clear();
+
+		if (aKeyframe.myEventsSorted)
+			myEvents->AssignShared(aKeyframe.myEvents, aKeyframe.myTime);
+		else
+			myEvents->Assign(*aKeyframe.myEvents, aKeyframe.myTime);
+		myUnits = aKeyframe.myUnits;
+		myTeams = aKeyframe.myTeams;
+		myNextSequence = aKeyframe.myNextSequence;
+		myEventHash = aKeyframe.myEventHash;
+		myTombstones = aKeyframe.myTombstones;
+
+		for (size_t i = aKeyframe.myActionCount; i < myActions.Size(); i++)
+		{
+			if (myActions[i].myAt >= aKeyframe.myTime)
+				QueueAction(static_cast<uint32_t>(i));
+		}
+
+		auto stale = std::lower_bound(myTickHashes.begin(), myTickHashes.end(), aKeyframe.myTime, [](const TickHash& aHash, uint64_t aTime)
+		{
+			return aHash.myTime < aTime;
+		});
+		myTickHashes.erase(stale, myTickHashes.end());
+
+		myNow = aKeyframe.myTime;
+		myUnresolvedFrom = aKeyframe.myTime;
+		myEventsSinceKeyframe = 0;
+		myUndo.Clear(aKeyframe.myTime);
 	}
 
-	void Unit::Reset()
+	void Timeline::InvalidateKeyframesAfter(uint64_t aTime, std::vector<Keyframe>* aRemoved)
 	{
-		myDamage = 0;
+		while (!myKeyframes.empty() && myKeyframes.back().myTime > aTime)
+		{
+			myKeyframeBytes -= myKeyframes.back().Bytes();
+
+			if (aRemoved)
+				aRemoved->push_back(std::move(myKeyframes.back()));
+
+			myKeyframes.pop_back();
+		}
 	}
 
-	bool Unit::IsDead()
+	void Timeline::EnforceKeyframeBudget()
 	{
-		return myDamage >= myHealth;
+		while (myKeyframeBytes > myKeyframeBudget && myKeyframes.size() > 1)
+		{
+			std::vector<Keyframe> kept;
+			kept.reserve(myKeyframes.size() / 2 + 1);
+
+			myKeyframeBytes = 0;
+			for (size_t i = 0; i < myKeyframes.size(); i += 2)
+			{
+				myKeyframeBytes += myKeyframes[i].Bytes();
+				kept.push_back(std::move(myKeyframes[i]));
+			}
+
+			myKeyframes = std::move(kept);
+			myKeyframeTickInterval *= 2;
+			myKeyframeEventInterval *= 2;
+		}
 	}
 
-	void Unit::Damage(int aAmount)
+	Keyframe* Timeline::FindKeyframe(uint64_t aTime)
 	{
-		if (IsDead())
-			return;
-		
-		myDamage += aAmount;
+		auto after = std::upper_bound(myKeyframes.begin(), myKeyframes.end(), aTime, [](uint64_t aTime, const Keyframe& aKeyframe)
+		{
+			return aTime < aKeyframe.myTime;
+		});
 
-		if (IsDead())
-			OnDeath.Fire();
+		if (after == myKeyframes.begin())
+			return nullptr;
+
+		return &*std::prev(after);
 	}
 
-	void Unit::Attack(Timeline& aTimeline)
+	bool Timeline::Rewind(uint64_t aTime)
 	{
-		if (IsDead())
-			return;
+		if (!myUndo.Covers(aTime))
+			return false;
 
-		aTimeline.QueueEvent(Event(aTimeline.GetTime(100), [this, &aTimeline]()
+		// Everything queued while resolving aTime or later is keyed past this, see QueueEvent
+		uint64_t queuedAfter = (aTime + 1) * FirstDynamicSequence;
+
+		myEventScratch.clear();
+		myEvents->Collect(myEventScratch);
+		std::erase_if(myEventScratch, [queuedAfter](const Event& aEvent)
 		{
-			Attack(aTimeline);
-		}));
+			return aEvent.GetSequence() >= queuedAfter;
+		});
 
-		for (std::shared_ptr<Unit> unit : aTimeline.GetUnits())
+		while (!myUndo.Empty() && myUndo.Newest().myAt >= aTime)
 		{
-			if (unit->myTeam != myTeam)
+			ResolvedEvent resolved = myUndo.Newest();
+
+			myUndo.PopNewest([this](const UnitChange& aChange)
 			{
-				unit->Damage(1);
-				return;
-			}
+				Revert(aChange);
+			});
+
+			if (resolved.myEvent.GetSequence() < queuedAfter)
+				myEventScratch.push_back(resolved.myEvent);
+
+			myNextSequence = resolved.myNextSequence;
+			myEventHash = resolved.myEventHash;
+			myTombstones = resolved.myTombstones;
+		}
+
+		myEventsToAdd.clear();
+		myEvents->Assign(myEventScratch, aTime);
+
+		auto stale = std::lower_bound(myTickHashes.begin(), myTickHashes.end(), aTime, [](const TickHash& aHash, uint64_t aTime)
+		{
+			return aHash.myTime < aTime;
+		});
+		myTickHashes.erase(stale, myTickHashes.end());
+
+		myNow = aTime;
+		myUnresolvedFrom = aTime;
+		myEventsSinceKeyframe = 0;
+
+		return true;
+	}
+
+	void Timeline::Revert(const UnitChange& aChange)
+	{
+		switch (aChange.myKind)
+		{
+		case UnitChange::Kind::Spawn:
+			myTeams.UndoAdd(aChange.myUnit, aChange.myTeam);
+			myUnits.UndoCreate(aChange.myUnit, aChange.myPrevious);
+			break;
+		case UnitChange::Kind::Damage:
+		{
+			int before = static_cast<int>(aChange.myPrevious);
+
+			if (aChange.myKilled)
+				myTeams.UndoRemove(aChange.myUnit, aChange.myTeam, before, aChange.myMemberPosition, aChange.myDamagePosition);
+			else
+				myTeams.UndoDamaged(aChange.myUnit, aChange.myTeam, before, before + aChange.myAmount, aChange.myDamagePosition);
+
+			myUnits.AddDamage(aChange.myUnit, -aChange.myAmount);
+			break;
+		}
+		case UnitChange::Kind::Remove:
+			myUnits.UndoDestroy(aChange.myUnit, aChange.myMemberPosition, aChange.myTeam, aChange.myNameId, static_cast<int>(aChange.myPrevious));
+			break;
+		case UnitChange::Kind::Retarget:
+			myTeams.RoundRobinCursor(aChange.myTeam) = aChange.myPrevious;
+			break;
 		}
 	}
 
-	float Unit::GetHealthPercent()
+	uint64_t Timeline::WorldHash()
 	{
-		return 1.f - static_cast<float>(myDamage) / static_cast<float>(myHealth);
+		return myUnits.Hash() ^ myTeams.Hash();
 	}
 
-	SpawnAction::SpawnAction(uint64_t aAt, Timeline& aTimeline, Unit::Team aTeam)
-		: Action(aAt)
-		, myTimeline(aTimeline)
-		, myUnit(std::make_shared<Unit>(aTeam))
+	void Timeline::RecordTickHash(uint64_t aTime)
 	{
+		// Only the newest ticks are kept. An edit from before them can still converge, just no earlier than
+		// where they start. Dropping half at a time keeps the vector from reallocating.
+		if (myTickHashes.size() >= 2 * MaxTickHashes)
+			myTickHashes.erase(myTickHashes.begin(), myTickHashes.end() - MaxTickHashes);
 
+		myTickHashes.push_back(TickHash{ aTime, WorldHash(), myEventHash });
 	}
 
-	Event SpawnAction::AsEvent()
+	void Timeline::BeginConvergence(uint64_t aEditTick)
 	{
-		return Event(GetWhen(), [this]()
+		Convergence& convergence = myConvergence.emplace();
+
+		convergence.myEditTick = aEditTick;
+		convergence.myUnresolvedFrom = myUnresolvedFrom;
+		Snapshot(convergence.mySnapshot, myNow);
+
+		auto edited = std::upper_bound(myTickHashes.begin(), myTickHashes.end(), aEditTick, [](uint64_t aTime, const TickHash& aHash)
 		{
-			myUnit->Reset();
-			myTimeline.AddUnit(myUnit);
+			return aTime < aHash.myTime;
 		});
+		convergence.myHashes.assign(edited, myTickHashes.end());
+
+		InvalidateKeyframesAfter(aEditTick, &convergence.myKeyframes);
+		std::reverse(convergence.myKeyframes.begin(), convergence.myKeyframes.end());
+	}
+
+	bool Timeline::HasConverged(uint64_t aTime)
+	{
+		Convergence& convergence = *myConvergence;
+
+		if (aTime <= convergence.myEditTick)
+			return false;
+
+		while (convergence.myNextHash < convergence.myHashes.size() && convergence.myHashes[convergence.myNextHash].myTime < aTime)
+			convergence.myNextHash++;
+
+		if (convergence.myNextHash == convergence.myHashes.size())
+			return false;
+
+		const TickHash& before = convergence.myHashes[convergence.myNextHash];
+
+		return before.myTime == aTime && before.myWorld == WorldHash() && before.myEvents == myEventHash;
+	}
+
+	void Timeline::Splice(uint64_t aTime)
+	{
+		Convergence& convergence = *myConvergence;
+
+		RestoreKeyframe(convergence.mySnapshot);
+		myUnresolvedFrom = convergence.myUnresolvedFrom;
+
+		myTickHashes.insert(myTickHashes.end(), convergence.myHashes.begin() + convergence.myNextHash, convergence.myHashes.end());
+
+		for (Keyframe& keyframe : convergence.myKeyframes)
+		{
+			if (keyframe.myTime < aTime)
+				continue;
+
+			myKeyframeBytes += keyframe.Bytes();
+			myKeyframes.push_back(std::move(keyframe));
+		}
+		EnforceKeyframeBudget();
+
+		myLastResimulation.myConvergedTicks = myNow - aTime;
+		myLastResimulation.myTicks -= myLastResimulation.myConvergedTicks;
+		myTicksSavedByConvergence += myLastResimulation.myConvergedTicks;
+	}
+
+	size_t Keyframe::Bytes() const
+	{
+		return sizeof(Keyframe)
+			+ myEvents->capacity() * sizeof(Event)
+			+ myUnits.Bytes()
+			+ myTeams.Bytes();
 	}
-}
\ No newline at end of file
+}
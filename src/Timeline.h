@@ -1,112 +1,276 @@
 
+#pragma once
+
 #include <cstdint>
 #include <vector>
-#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
 
-#include "tools/Event.h"
+#include "ChunkedColumn.h"
+#include "DamageBuffer.h"
+#include "EventQueue.h"
+#include "Targeting.h"
+#include "UndoLog.h"
+#include "UnitStore.h"
+#include "WorkerPool.h"
 
 namespace fisk
 {
-
-	class Event
+	class Action
 	{
 	public:
-		Event(uint64_t aAt, std::function<void()> aCallback);
+		enum class Kind : uint8_t
+		{
+			Spawn
+		};
+
+		static Action Spawn(Team aTeam);
 
-		bool operator<(const Event& aOther) const;
-		uint64_t GetWhen();
+		Kind GetKind() const;
+		void Resolve(Timeline& aTimeline, uint32_t aIndex) const;
 
-		void Resolve();
 	private:
-		uint64_t myAt;
-		std::function<void()> myCallback;
+		Action(Kind aKind, Team aTeam, uint8_t aNameId);
+
+		Kind myKind;
+		Team myTeam;
+		uint8_t myNameId;
 	};
 
-	class Action
+	struct ScheduledAction
 	{
-	public:
-		Action(uint64_t aAt);
-
-		virtual Event AsEvent() = 0;
-		uint64_t GetWhen();
-	private:
 		uint64_t myAt;
+		Action myAction;
 	};
 
-	class Timeline;
+	struct AttackIntent
+	{
+		UnitHandle myTarget;
+		Team myTeam = Team::Friend;
+		uint32_t myNth = 0;
+		bool myCancelled = false;
+		bool myAttacks = false;
+		bool myHits = false;
+	};
 
-	class Unit
+	struct ParallelStats
 	{
-	public:
-		enum class Team
-		{
-			Friend,
-			Foe
-		};
+		// Batches whose targets were picked on the pool, and the attacks in them
+		uint64_t myBatches = 0;
+		uint64_t myAttacks = 0;
+		// Batches large enough to split but resolved serially, immediate damage lets every hit change what
+		// the next attack sees
+		uint64_t mySerialBatches = 0;
+	};
 
-		Unit(Team aTeam);
-		
-		void OnSpawned(Timeline& aTimeline);
+	struct Resimulation
+	{
+		uint64_t myTicks = 0;
+		uint64_t myFullReplayTicks = 0;
+		uint64_t myConvergedTicks = 0;
+	};
 
-		void Reset();
-		bool IsDead();
-		void Damage(int aAmount);
-		void Attack(Timeline& aTimeline);
-		float GetHealthPercent();
+	struct Keyframe
+	{
+		uint64_t myTime;
+		// Forks read the events in place, the first fork from a keyframe sorts them earliest first
+		std::shared_ptr<const std::vector<Event>> myEvents;
+		bool myEventsSorted = false;
+		UnitStore myUnits;
+		TeamIndex myTeams;
+		uint64_t myNextSequence;
+		uint64_t myEventHash;
+		size_t myTombstones;
+		size_t myActionCount;
 
-		tools::Event<> OnDeath;
+		size_t Bytes() const;
+	};
 
+	struct UnitView
+	{
+		uint32_t myIndex;
 		Team myTeam;
-		std::string myName;
-
-		static const int myHealth = 15;
-		int myDamage = 0;
+		uint8_t myNameId;
+		float myHealth;
 	};
 
-
-	class SpawnAction : public Action
+	struct WorldSnapshot
 	{
-	public:
-		SpawnAction(uint64_t aAt, Timeline& aTimeline, Unit::Team aTeam);
+		uint64_t myTime = 0;
+		uint64_t myMaxTime = 0;
+		std::vector<uint64_t> myActionTimes;
+		std::vector<Event> myEvents;
+		std::vector<uint64_t> myKeyframeTimes;
+		std::vector<UnitView> myUnits;
 
-		Event AsEvent() override;
+		Resimulation myLastResimulation;
+		uint64_t myTicksSavedByConvergence = 0;
+		uint64_t myResolvedEvents = 0;
+		uint64_t myCancelledEvents = 0;
+		uint64_t myCompactedEvents = 0;
+		size_t myKeyframeBytes = 0;
+		size_t myKeyframeBudget = 0;
+		size_t myUndoEvents = 0;
+		size_t myUndoBytes = 0;
+		uint64_t myUndoFrom = 0;
 
-	private:
-		Timeline& myTimeline;
-		std::shared_ptr<Unit> myUnit;
+		EventQueue::Backend myBackend = EventQueue::Backend::BinaryHeap;
+		TargetingPolicy::Kind myTargeting = TargetingPolicy::Kind::First;
+		DamageResolution myDamageResolution = DamageResolution::Immediate;
 	};
 
+	struct TickHash
+	{
+		uint64_t myTime;
+		uint64_t myWorld;
+		uint64_t myEvents;
+	};
+
+	struct Convergence
+	{
+		uint64_t myEditTick;
+		uint64_t myUnresolvedFrom;
+		Keyframe mySnapshot;
+		std::vector<TickHash> myHashes;
+		size_t myNextHash = 0;
+		std::vector<Keyframe> myKeyframes;
+	};
 
 	class Timeline
 	{
 	public:
+		static constexpr uint64_t FirstDynamicSequence = uint64_t(1) << 32;
+		static constexpr size_t MinTombstonesToCompact = 1024;
+		static constexpr size_t MaxTickHashes = 1 << 16;
+		static constexpr size_t TombstoneShareToCompact = 4;
+		static constexpr uint32_t AttackPeriod = 100;
+		static constexpr size_t MinParallelBatch = 512;
+
+		Timeline();
+
 		uint64_t GetTime(uint64_t aOffset = 0);
+		uint64_t GetMaxTime();
 
-		void ImguiDrawTimeline();
-		void Advance();
+		void Advance(uint64_t aTicks = 1);
+		void Seek(uint64_t aTime);
 
 		void SpawnFriend();
 		void SpawnFoe();
+		void SpawnWave(Team aTeam, size_t aCount);
+
+		uint64_t InsertAction(Action aAction, uint64_t aTick);
+		uint64_t InsertActions(std::span<const Action> aActions, uint64_t aTick);
+		void ResolveAction(uint32_t aIndex);
+		Resimulation GetLastResimulation();
+		uint64_t GetTicksSavedByConvergence();
+
+		UnitHandle AddUnit(Team aTeam, uint8_t aNameId, uint32_t aGeneration);
+		void Attack(UnitHandle aUnit);
+		void Damage(UnitHandle aUnit, int aAmount);
+		void RemoveUnit(UnitHandle aUnit);
 
-		void AddUnit(std::shared_ptr<Unit> aUnit);
+		void StartTimer(TimerCall aCall, UnitHandle aOwner, uint32_t aPeriod, uint64_t aPhase);
+		void FireTimer(const Event& aTimer);
 
 		void QueueEvent(Event aEvent);
+		void QueueEvents(std::span<const Event> aEvents);
 
-		std::vector<std::shared_ptr<Unit>>& GetUnits();
-	private:
+		void SetQueueBackend(EventQueue::Backend aBackend);
+		void SetTargeting(TargetingPolicy::Kind aKind);
+		void SetDamageResolution(DamageResolution aResolution);
+		void SetKeyframeIntervals(uint64_t aTicks, uint64_t aEvents);
+		void SetConvergenceTracking(bool aEnabled);
+		void SetUndoCapacity(size_t aEvents, size_t aChanges);
+		void SetParallelism(size_t aThreads);
+		ParallelStats GetParallelStats();
+		uint64_t GetStateHash();
+		uint64_t GetResolvedEvents();
+		uint64_t GetCancelledEvents();
+		uint64_t GetRevision();
+		size_t GetKeyframeBytes();
+		uint64_t GetKeyframeTime(uint64_t aTime);
+		// Memory that no other timeline or keyframe shares, for a fork what it has cost since it was taken
+		size_t GetOwnedBytes();
+
+		// The fork shares units, actions and pending events with the keyframe it starts from and copies
+		// what it writes to. It is simulated up to aTime before it is returned.
+		Timeline Fork(uint64_t aTime, uint64_t aKeyframeTicks, uint64_t aKeyframeEvents);
+		std::vector<Keyframe> TakeKeyframes();
+		size_t AdoptKeyframes(std::vector<Keyframe>&& aKeyframes, uint64_t aRevision);
 
+		const UnitStore& GetUnits();
+		void Capture(WorldSnapshot& aOut);
+	private:
 		void FlushPendingEvents();
+		bool IsCancelled(const Event& aEvent);
+		void FireTimers();
+		void ApplyDamage(UnitHandle aUnit, int aAmount);
+		void ApplyBufferedDamage();
+		void FireTimersFrozen();
+		bool RunTimer(TimerCall aCall, UnitHandle aOwner);
+		void CompactEvents();
 		void Reset();
 		void Goto(uint64_t aTime);
 
+		void QueueAction(uint32_t aIndex);
+		void Snapshot(Keyframe& aOut, uint64_t aTime);
+		void CaptureKeyframe(uint64_t aTime);
+		void RestoreKeyframe(const Keyframe& aKeyframe);
+		void InvalidateKeyframesAfter(uint64_t aTime, std::vector<Keyframe>* aRemoved = nullptr);
+		void EnforceKeyframeBudget();
+		Keyframe* FindKeyframe(uint64_t aTime);
+
+		bool Rewind(uint64_t aTime);
+		void Revert(const UnitChange& aChange);
+
+		uint64_t WorldHash();
+		void RecordTickHash(uint64_t aTime);
+		void BeginConvergence(uint64_t aEditTick);
+		bool HasConverged(uint64_t aTime);
+		void Splice(uint64_t aTime);
+
 		uint64_t myMaxTime = 0;
 		uint64_t myNow = 0;
+		uint64_t myUnresolvedFrom = 0;
+		uint64_t myRevision = 0;
+		Resimulation myLastResimulation;
 
-		std::vector<Event> myEventsToAdd;
-		std::vector<Event> myEvents;
-		std::vector<Action*> myActions;
-		std::vector<std::shared_ptr<Unit>> myUnits;
+		uint64_t myKeyframeTickInterval = 1000;
+		uint64_t myKeyframeEventInterval = 4096;
+		size_t myKeyframeBudget = 64 * 1024 * 1024;
+
+		uint64_t myResolvedEvents = 0;
+		uint64_t myCancelledEvents = 0;
+		uint64_t myCompactedEvents = 0;
+		size_t myTombstones = 0;
+		uint64_t myEventsSinceKeyframe = 0;
+		size_t myKeyframeBytes = 0;
+		std::vector<Keyframe> myKeyframes;
+
+		bool myConvergenceTracking = true;
+		uint64_t myTicksSavedByConvergence = 0;
+		std::vector<TickHash> myTickHashes;
+		std::optional<Convergence> myConvergence;
 
-		std::vector<tools::EventReg> myEventHandles;
+		UndoLog myUndo;
+		std::vector<Event> myEventScratch;
+		std::vector<Event> myTimerBatch;
+
+		std::unique_ptr<WorkerPool> myPool;
+		std::vector<AttackIntent> myIntents;
+		ParallelStats myParallelStats;
+
+		uint64_t myNextSequence = FirstDynamicSequence;
+		uint64_t myEventHash = 0;
+		std::vector<Event> myEventsToAdd;
+		std::unique_ptr<EventQueue> myEvents;
+		ChunkedColumn<ScheduledAction> myActions;
+		UnitStore myUnits;
+		TeamIndex myTeams;
+		std::unique_ptr<TargetingPolicy> myTargeting;
+		DamageResolution myDamageResolution = DamageResolution::Immediate;
+		DamageBuffer myDamageBuffer;
+		std::vector<UnitHandle> myDying;
 	};
 }
\ No newline at end of file
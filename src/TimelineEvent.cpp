@@ -0,0 +1,116 @@
+#include "TimelineEvent.h"
+#include "Timeline.h"
+#include "Zobrist.h"
+
+namespace fisk
+{
+	Event::Event(uint64_t aAt, Kind aKind)
+	{
+		myAt = aAt;
+		myKind = aKind;
+	}
+
+	Event Event::ForAction(uint64_t aAt, uint32_t aActionIndex)
+	{
+		Event event(aAt, Kind::Action);
+		event.myActionIndex = aActionIndex;
+		return event;
+	}
+
+	Event Event::Timer(uint64_t aAt, TimerCall aCall, UnitHandle aOwner, uint32_t aPeriod)
+	{
+		Event event(aAt, Kind::Timer);
+		event.myUnit = aOwner;
+		event.myTimerCall = aCall;
+		event.myPeriod = aPeriod;
+		return event;
+	}
+
+	Event Event::RemoveUnit(uint64_t aAt, UnitHandle aUnit)
+	{
+		Event event(aAt, Kind::RemoveUnit);
+		event.myUnit = aUnit;
+		return event;
+	}
+
+	bool Event::operator<(const Event& aOther) const
+	{
+		if (myAt != aOther.myAt)
+			return aOther.myAt < myAt;
+
+		return aOther.mySequence < mySequence;
+	}
+
+	uint64_t Event::GetWhen() const
+	{
+		return myAt;
+	}
+
+	uint64_t Event::GetSequence() const
+	{
+		return mySequence;
+	}
+
+	void Event::SetSequence(uint64_t aSequence)
+	{
+		mySequence = aSequence;
+	}
+
+	Event::Kind Event::GetKind() const
+	{
+		return myKind;
+	}
+
+	UnitHandle Event::GetOwner() const
+	{
+		return myKind == Kind::Timer ? myUnit : UnitHandle();
+	}
+
+	TimerCall Event::GetTimerCall() const
+	{
+		return myTimerCall;
+	}
+
+	Event Event::Rearmed() const
+	{
+		Event event = *this;
+		event.myAt += myPeriod;
+		return event;
+	}
+
+	uint64_t Event::Hash() const
+	{
+		uint64_t payload = 0;
+
+		switch (myKind)
+		{
+		case Kind::Action:
+			payload = myActionIndex;
+			break;
+		case Kind::Timer:
+			payload = ZobristKey(myUnit.myGeneration, static_cast<uint64_t>(myTimerCall), myPeriod);
+			break;
+		case Kind::RemoveUnit:
+			payload = myUnit.myGeneration;
+			break;
+		}
+
+		return ZobristKey(myAt, mySequence, static_cast<uint64_t>(myKind), payload);
+	}
+
+	void Event::Resolve(Timeline& aTimeline) const
+	{
+		switch (myKind)
+		{
+		case Kind::Action:
+			aTimeline.ResolveAction(myActionIndex);
+			break;
+		case Kind::Timer:
+			aTimeline.FireTimer(*this);
+			break;
+		case Kind::RemoveUnit:
+			aTimeline.RemoveUnit(myUnit);
+			break;
+		}
+	}
+}
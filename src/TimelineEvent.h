@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "UnitStore.h"
+
+namespace fisk
+{
+	class Timeline;
+
+	enum class TimerCall : uint8_t
+	{
+		Attack
+	};
+
+	class Event
+	{
+	public:
+		enum class Kind : uint8_t
+		{
+			Action,
+			Timer,
+			RemoveUnit
+		};
+
+		static Event ForAction(uint64_t aAt, uint32_t aActionIndex);
+		static Event Timer(uint64_t aAt, TimerCall aCall, UnitHandle aOwner, uint32_t aPeriod);
+		static Event RemoveUnit(uint64_t aAt, UnitHandle aUnit);
+
+		bool operator<(const Event& aOther) const;
+		uint64_t GetWhen() const;
+		uint64_t GetSequence() const;
+		Kind GetKind() const;
+		UnitHandle GetOwner() const;
+		TimerCall GetTimerCall() const;
+		Event Rearmed() const;
+		uint64_t Hash() const;
+
+		void SetSequence(uint64_t aSequence);
+
+		void Resolve(Timeline& aTimeline) const;
+	private:
+		Event(uint64_t aAt, Kind aKind);
+
+		uint64_t myAt;
+		uint64_t mySequence = 0;
+		union
+		{
+			uint32_t myActionIndex;
+			UnitHandle myUnit;
+		};
+		Kind myKind;
+		TimerCall myTimerCall = TimerCall::Attack;
+		uint32_t myPeriod = 0;
+	};
+
+	static_assert(std::is_trivially_copyable_v<Event>);
+	static_assert(sizeof(Event) <= 32);
+}
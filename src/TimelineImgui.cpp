@@ -0,0 +1,202 @@
+#include "SimulationThread.h"
+#include "imgui/imgui.h"
+#include <algorithm>
+#include <utility>
+
+namespace fisk
+{
+	void SimulationThread::ImguiDrawTimeline()
+	{
+		const WorldSnapshot& world = Read();
+
+		ImDrawList* drawlist = ImGui::GetWindowDrawList();
+		float width = 500;
+
+		ImVec2 topleft = ImGui::GetCursorScreenPos();
+
+		auto getX = [&](uint64_t aTime)
+		{
+			return topleft.x + static_cast<float>(aTime) / static_cast<float>(std::max<uint64_t>(world.myMaxTime, 1)) * width;
+		};
+
+		auto poi = [&](uint64_t aTime, const char* aName, float aImportance, ImColor aColor = ImColor(200, 200, 200))
+		{
+			float x = getX(aTime);
+			drawlist->AddLine(ImVec2(x, topleft.y), ImVec2(x, topleft.y + aImportance), aColor);
+			drawlist->AddText(ImVec2(x, topleft.y + aImportance), aColor, aName);
+		};
+
+		drawlist->AddLine(topleft, ImVec2(topleft.x + width, topleft.y), ImColor(255, 255, 255));
+
+		poi(world.myTime, "Now", 40);
+
+		for (uint64_t at : world.myActionTimes)
+		{
+			poi(at, "S", 20, ImColor(255, 100, 70, 128));
+		}
+
+		for (const Event& e : world.myEvents)
+		{
+			poi(e.GetWhen(), "e", 10);
+		}
+
+		for (uint64_t keyframe : world.myKeyframeTimes)
+		{
+			poi(keyframe, "k", 5, ImColor(100, 150, 255, 128));
+		}
+
+
+		ImGui::Dummy(ImVec2(width, 50));
+		int32_t target_time = static_cast<int32_t>(world.myTime);
+		if (ImGui::SliderInt("##target_time", &target_time, 0, static_cast<int32_t>(world.myMaxTime), "", ImGuiSliderFlags_AlwaysClamp))
+		{
+			Send(SimulationCommand::Seek(target_time));
+		}
+		ImGui::Separator();
+
+		if (ImGui::Button("Go back"))
+			Send(SimulationCommand::Rewind(600));
+
+		if (ImGui::Button("Spawn Friend"))
+			Send(SimulationCommand::Spawn(Team::Friend, 1));
+		if (ImGui::Button("Spawn Foe"))
+			Send(SimulationCommand::Spawn(Team::Foe, 1));
+		if (ImGui::Button("Spawn 100 Friends"))
+			Send(SimulationCommand::Spawn(Team::Friend, 100));
+		if (ImGui::Button("Spawn 100 Foes"))
+			Send(SimulationCommand::Spawn(Team::Foe, 100));
+
+		static int insertAt = 0;
+		ImGui::InputInt("Insert at tick", &insertAt);
+		insertAt = std::clamp(insertAt, 0, static_cast<int>(world.myMaxTime));
+		if (ImGui::Button("Insert Friend"))
+			Send(SimulationCommand::Insert(Team::Friend, insertAt));
+		ImGui::SameLine();
+		if (ImGui::Button("Insert Foe"))
+			Send(SimulationCommand::Insert(Team::Foe, insertAt));
+
+		ImGui::Text("Last edit resimulated %llu ticks (full replay: %llu)", static_cast<unsigned long long>(world.myLastResimulation.myTicks), static_cast<unsigned long long>(world.myLastResimulation.myFullReplayTicks));
+		ImGui::Text("Ticks saved by convergence: %llu", static_cast<unsigned long long>(world.myTicksSavedByConvergence));
+		ImGui::Text("Pops wasted on cancelled events: %llu (%llu compacted away)", static_cast<unsigned long long>(world.myCancelledEvents), static_cast<unsigned long long>(world.myCompactedEvents));
+
+		ImGui::Separator();
+
+		int tickRate = static_cast<int>(GetTickRate());
+		if (ImGui::SliderInt("Ticks per second", &tickRate, 1, 1000, "%d", ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_AlwaysClamp))
+			Send(SimulationCommand::SetTickRate(static_cast<uint32_t>(tickRate)));
+		ImGui::Text("Dropped ticks: %llu", static_cast<unsigned long long>(GetDroppedTicks()));
+
+		const std::pair<const char*, uint32_t> speeds[] = { { "1x", 1 }, { "10x", 10 }, { "100x", 100 }, { "Max", MaxSpeed } };
+		for (const auto& [label, multiplier] : speeds)
+		{
+			if (ImGui::RadioButton(label, GetSpeed() == multiplier))
+				Send(SimulationCommand::SetSpeed(multiplier));
+			ImGui::SameLine();
+		}
+		ImGui::Text("Measured: %llu ticks/s", static_cast<unsigned long long>(GetMeasuredTickRate()));
+
+		const char* backends[] = { "Binary heap", "Timing wheel" };
+		int backend = static_cast<int>(world.myBackend);
+		if (ImGui::Combo("Event queue", &backend, backends, static_cast<int>(std::size(backends))))
+			Send(SimulationCommand::SetQueueBackend(static_cast<EventQueue::Backend>(backend)));
+
+		const char* policies[] = { "First", "Round robin", "Most damaged" };
+		int policy = static_cast<int>(world.myTargeting);
+		if (ImGui::Combo("Targeting", &policy, policies, static_cast<int>(std::size(policies))))
+			Send(SimulationCommand::SetTargeting(static_cast<TargetingPolicy::Kind>(policy)));
+
+		const char* resolutions[] = { "Immediate", "Simultaneous" };
+		int resolution = static_cast<int>(world.myDamageResolution);
+		if (ImGui::Combo("Damage", &resolution, resolutions, static_cast<int>(std::size(resolutions))))
+			Send(SimulationCommand::SetDamageResolution(static_cast<DamageResolution>(resolution)));
+
+		ImGui::Text("Keyframes: %zu (%.1f KiB of %.1f KiB)", world.myKeyframeTimes.size(), static_cast<float>(world.myKeyframeBytes) / 1024.f, static_cast<float>(world.myKeyframeBudget) / 1024.f);
+		ImGui::Text("Warmed keyframes adopted: %llu", static_cast<unsigned long long>(GetWarmedKeyframes()));
+		ImGui::Text("Undo log: %zu events back to tick %llu (%.1f KiB)", world.myUndoEvents, static_cast<unsigned long long>(world.myUndoFrom), static_cast<float>(world.myUndoBytes) / 1024.f);
+
+		ImGui::Separator();
+
+		ImGui::Text("Units");
+
+		for (const UnitView& unit : world.myUnits)
+		{
+			switch (unit.myTeam)
+			{
+			case Team::Foe:
+				ImGui::PushStyleColor(ImGuiCol_Button, ImColor(255, 100, 100).Value);
+				ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImColor(255, 120, 120).Value);
+				ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImColor(255, 150, 150).Value);
+				break;
+			}
+
+
+			ImGui::PushID(static_cast<int>(unit.myIndex));
+			ImGui::Button(UnitStore::NameOf(unit.myNameId));
+			ImGui::PopID();
+			ImGui::SameLine();
+
+			ImGui::PushStyleColor(ImGuiCol_ScrollbarGrab, ImColor(100, 255, 150).Value);
+			ImGui::ProgressBar(unit.myHealth);
+			ImGui::PopStyleColor(1);
+
+			switch (unit.myTeam)
+			{
+			case Team::Foe:
+				ImGui::PopStyleColor(3);
+				break;
+			}
+		}
+	}
+
+	void SimulationThread::ImguiDrawBranches()
+	{
+		const WorldSnapshot& world = Read();
+
+		static int team = 0;
+		static int count = 100;
+		static int branchAt = 0;
+
+		ImGui::RadioButton("Friends", &team, 0);
+		ImGui::SameLine();
+		ImGui::RadioButton("Foes", &team, 1);
+		ImGui::InputInt("Spawn count", &count);
+		ImGui::InputInt("Branch at tick", &branchAt);
+		count = std::clamp(count, 1, 10000);
+		branchAt = std::clamp(branchAt, 0, static_cast<int>(world.myMaxTime));
+
+		if (ImGui::Button("Branch"))
+			Send(SimulationCommand::Branch(static_cast<Team>(team), branchAt, count));
+		ImGui::SameLine();
+		if (ImGui::Button("Clear branches"))
+			Send(SimulationCommand::ClearBranches());
+
+		myBranches.Capture(myBranchViews);
+
+		uint32_t most = 1;
+
+		for (const BranchView& branch : myBranchViews)
+		{
+			for (const BranchSample& sample : branch.mySamples)
+				most = std::max({ most, sample.myFriends, sample.myFoes });
+		}
+
+		for (const BranchView& branch : myBranchViews)
+		{
+			ImGui::Separator();
+
+			const BranchSample& last = branch.mySamples.back();
+			ImGui::Text("%s: tick %llu of %llu, %u friends, %u foes (%.1f KiB)", branch.myLabel.c_str(), static_cast<unsigned long long>(last.myTime), static_cast<unsigned long long>(branch.myUntil), last.myFriends, last.myFoes, static_cast<float>(branch.myBytes) / 1024.f);
+
+			auto friends = [](void* aData, int aIndex) { return static_cast<float>(static_cast<const BranchSample*>(aData)[aIndex].myFriends); };
+			auto foes = [](void* aData, int aIndex) { return static_cast<float>(static_cast<const BranchSample*>(aData)[aIndex].myFoes); };
+
+			void* samples = const_cast<BranchSample*>(branch.mySamples.data());
+			int sampleCount = static_cast<int>(branch.mySamples.size());
+
+			ImGui::PushID(&branch);
+			ImGui::PlotLines("Friends", friends, samples, sampleCount, 0, nullptr, 0.f, static_cast<float>(most), ImVec2(500, 40));
+			ImGui::PlotLines("Foes", foes, samples, sampleCount, 0, nullptr, 0.f, static_cast<float>(most), ImVec2(500, 40));
+			ImGui::PopID();
+		}
+	}
+}
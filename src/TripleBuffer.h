@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace fisk
+{
+	// One writer and one reader exchange whole values without locking: the writer fills its back
+	// buffer and swaps it into the middle, the reader swaps the middle out when it is newer than
+	// what it holds. Neither side ever waits on the other.
+	template<class Type>
+	class TripleBuffer
+	{
+	public:
+		Type& Back()
+		{
+			return myBuffers[myBack];
+		}
+
+		void Publish()
+		{
+			uint8_t previous = myMiddle.exchange(static_cast<uint8_t>(myBack | Fresh), std::memory_order_acq_rel);
+			myBack = previous & IndexMask;
+		}
+
+		const Type& Front()
+		{
+			if (myMiddle.load(std::memory_order_relaxed) & Fresh)
+			{
+				uint8_t previous = myMiddle.exchange(myFront, std::memory_order_acq_rel);
+				myFront = previous & IndexMask;
+			}
+
+			return myBuffers[myFront];
+		}
+
+	private:
+		static constexpr uint8_t IndexMask = 0x3;
+		static constexpr uint8_t Fresh = 0x4;
+
+		std::array<Type, 3> myBuffers;
+
+		alignas(64) uint8_t myBack = 0;
+		alignas(64) std::atomic<uint8_t> myMiddle = 1;
+		alignas(64) uint8_t myFront = 2;
+	};
+}
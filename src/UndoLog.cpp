@@ -0,0 +1,94 @@
+#include "UndoLog.h"
+
+#include <cassert>
+
+namespace fisk
+{
+	UndoLog::UndoLog(size_t aEventCapacity, size_t aChangeCapacity)
+		: myEvents(aEventCapacity, ResolvedEvent{ Event::ForAction(0, 0), 0, 0, 0, 0, 0 })
+		, myChanges(aChangeCapacity)
+		, myEventCapacity(aEventCapacity)
+		, myChangeCapacity(aChangeCapacity)
+	{
+	}
+
+	void UndoLog::Clear(uint64_t aFrom)
+	{
+		myEventsBegin = myEventsEnd = 0;
+		myChangesBegin = myChangesEnd = 0;
+		myFrom = aFrom;
+	}
+
+	void UndoLog::Resolved(const ResolvedEvent& aEvent)
+	{
+		if (myEventCapacity == 0 || myChangeCapacity == 0)
+		{
+			myFrom = aEvent.myAt + 1;
+			return;
+		}
+
+		if (myEventsEnd - myEventsBegin == myEventCapacity)
+			DropOldest();
+
+		ResolvedEvent event = aEvent;
+		event.myFirstChange = myChangesEnd;
+
+		myEvents[myEventsEnd % myEventCapacity] = event;
+		myEventsEnd++;
+	}
+
+	void UndoLog::Changed(const UnitChange& aChange)
+	{
+		while (!Empty() && myChangesEnd - myChangesBegin == myChangeCapacity)
+			DropOldest();
+
+		// A single event outgrew the ring and took itself with it, the rest of its changes are useless
+		if (Empty())
+			return;
+
+		myChanges[myChangesEnd % myChangeCapacity] = aChange;
+		myChangesEnd++;
+	}
+
+	bool UndoLog::Covers(uint64_t aTime) const
+	{
+		return aTime >= myFrom;
+	}
+
+	bool UndoLog::Empty() const
+	{
+		return myEventsBegin == myEventsEnd;
+	}
+
+	size_t UndoLog::Size() const
+	{
+		return myEventsEnd - myEventsBegin;
+	}
+
+	size_t UndoLog::Bytes() const
+	{
+		return myEvents.capacity() * sizeof(ResolvedEvent)
+			+ myChanges.capacity() * sizeof(UnitChange);
+	}
+
+	uint64_t UndoLog::Oldest() const
+	{
+		return myFrom;
+	}
+
+	const ResolvedEvent& UndoLog::Newest() const
+	{
+		assert(!Empty());
+
+		return myEvents[(myEventsEnd - 1) % myEventCapacity];
+	}
+
+	void UndoLog::DropOldest()
+	{
+		const ResolvedEvent& oldest = myEvents[myEventsBegin % myEventCapacity];
+		myFrom = oldest.myAt + 1;
+
+		myEventsBegin++;
+		myChangesBegin = Empty() ? myChangesEnd : myEvents[myEventsBegin % myEventCapacity].myFirstChange;
+	}
+}
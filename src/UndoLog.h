@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "TimelineEvent.h"
+#include "UnitStore.h"
+
+namespace fisk
+{
+	struct UnitChange
+	{
+		enum class Kind : uint8_t
+		{
+			Spawn,
+			Damage,
+			Remove,
+			Retarget
+		};
+
+		Kind myKind;
+		Team myTeam;
+		uint8_t myNameId = 0;
+		bool myKilled = false;
+		UnitHandle myUnit;
+
+		// Spawn: generation of the slot before it was reused. Damage and Remove: damage before the
+		// change. Retarget: round robin cursor before the attack.
+		uint32_t myPrevious = 0;
+		int myAmount = 0;
+
+		// Damage: positions in the team index before the unit was moved. Remove: dense index in the
+		// unit store, kept in myMemberPosition.
+		uint32_t myMemberPosition = 0;
+		uint32_t myDamagePosition = 0;
+	};
+
+	struct ResolvedEvent
+	{
+		Event myEvent;
+		uint64_t myAt;
+		uint64_t myNextSequence;
+		uint64_t myEventHash;
+		size_t myTombstones;
+		uint64_t myFirstChange; // Filled in by UndoLog::Resolved
+	};
+
+	// Bounded record of what Timeline::Goto did, newest last. Each resolved event owns the unit changes
+	// logged after it; the oldest events are dropped whole once either ring is full. Events dropped by
+	// compaction are logged the same way, at the tick they were dropped on and without changes. Both rings
+	// are allocated whole by the constructor, recording never allocates.
+	class UndoLog
+	{
+	public:
+		static constexpr size_t DefaultEventCapacity = 1 << 16;
+		static constexpr size_t DefaultChangeCapacity = 1 << 18;
+
+		UndoLog(size_t aEventCapacity = DefaultEventCapacity, size_t aChangeCapacity = DefaultChangeCapacity);
+
+		void Clear(uint64_t aFrom);
+
+		void Resolved(const ResolvedEvent& aEvent);
+		void Changed(const UnitChange& aChange);
+
+		bool Covers(uint64_t aTime) const;
+		bool Empty() const;
+		size_t Size() const;
+		size_t Bytes() const;
+		uint64_t Oldest() const;
+
+		const ResolvedEvent& Newest() const;
+
+		template<class Callback>
+		void PopNewest(Callback&& aRevert);
+
+	private:
+		void DropOldest();
+
+		std::vector<ResolvedEvent> myEvents;
+		std::vector<UnitChange> myChanges;
+		size_t myEventCapacity;
+		size_t myChangeCapacity;
+
+		uint64_t myEventsBegin = 0;
+		uint64_t myEventsEnd = 0;
+		uint64_t myChangesBegin = 0;
+		uint64_t myChangesEnd = 0;
+
+		uint64_t myFrom = 0;
+	};
+
+	template<class Callback>
+	inline void UndoLog::PopNewest(Callback&& aRevert)
+	{
+		const ResolvedEvent& newest = Newest();
+
+		while (myChangesEnd > newest.myFirstChange)
+		{
+			myChangesEnd--;
+			aRevert(myChanges[myChangesEnd % myChangeCapacity]);
+		}
+
+		myEventsEnd--;
+	}
+}
@@ -0,0 +1,282 @@
+#include "UnitStore.h"
+#include "Zobrist.h"
+
+#include <cassert>
+
+namespace fisk
+{
+	const char* UnitStore::NameOf(uint8_t aNameId)
+	{
+		const char* names[] = {
+			"Bob",
+			"Alice",
+			"Tamara",
+			"Pogo",
+			"Tammy",
+			"Benny",
+			"Job",
+			"Craig"
+		};
+
+		return names[aNameId % (sizeof(names) / sizeof(*names))];
+	}
+
+	uint8_t UnitStore::NextNameId()
+	{
+		static uint8_t counter = 0;
+		return counter++;
+	}
+
+	UnitHandle UnitStore::Create(Team aTeam, uint8_t aNameId, uint32_t aGeneration)
+	{
+		uint32_t slot;
+
+		if (myFreeSlots.Empty())
+		{
+			slot = static_cast<uint32_t>(mySlotToDense.Size());
+
+			mySlotToDense.Push(Vacant);
+			myGenerations.Push(0);
+		}
+		else
+		{
+			slot = myFreeSlots.Back();
+			myFreeSlots.Pop();
+		}
+
+		mySlotToDense.Mutable(slot) = static_cast<uint32_t>(myDenseToSlot.Size());
+		myGenerations.Mutable(slot) = aGeneration;
+
+		myTeams.Push(aTeam);
+		myDamage.Push(0);
+		myNameIds.Push(aNameId);
+		myDenseToSlot.Push(slot);
+
+		myHash ^= KeyOf(mySlotToDense[slot]);
+
+		return UnitHandle{ slot, aGeneration };
+	}
+
+	void UnitStore::Destroy(UnitHandle aHandle)
+	{
+		if (!IsAlive(aHandle))
+			return;
+
+		uint32_t dense = mySlotToDense[aHandle.myIndex];
+		uint32_t last = static_cast<uint32_t>(myDenseToSlot.Size() - 1);
+
+		myHash ^= KeyOf(dense);
+
+		if (dense != last)
+		{
+			myTeams.Mutable(dense) = myTeams[last];
+			myDamage.Mutable(dense) = myDamage[last];
+			myNameIds.Mutable(dense) = myNameIds[last];
+			myDenseToSlot.Mutable(dense) = myDenseToSlot[last];
+
+			mySlotToDense.Mutable(myDenseToSlot[dense]) = dense;
+		}
+
+		myTeams.Pop();
+		myDamage.Pop();
+		myNameIds.Pop();
+		myDenseToSlot.Pop();
+
+		mySlotToDense.Mutable(aHandle.myIndex) = Vacant;
+		myFreeSlots.Push(aHandle.myIndex);
+	}
+
+	void UnitStore::Clear()
+	{
+		myTeams.Clear();
+		myDamage.Clear();
+		myNameIds.Clear();
+		myDenseToSlot.Clear();
+
+		mySlotToDense.Clear();
+		myGenerations.Clear();
+		myFreeSlots.Clear();
+
+		myHash = 0;
+	}
+
+	uint32_t UnitStore::NextGeneration() const
+	{
+		return myFreeSlots.Empty() ? 0 : myGenerations[myFreeSlots.Back()];
+	}
+
+	void UnitStore::UndoCreate(UnitHandle aHandle, uint32_t aPreviousGeneration)
+	{
+		assert(mySlotToDense[aHandle.myIndex] == myDenseToSlot.Size() - 1 && "Creations are undone newest first");
+
+		myHash ^= KeyOf(mySlotToDense[aHandle.myIndex]);
+
+		myTeams.Pop();
+		myDamage.Pop();
+		myNameIds.Pop();
+		myDenseToSlot.Pop();
+
+		// Appended slots are handed back through the free list too, the next Create picks the same one
+		mySlotToDense.Mutable(aHandle.myIndex) = Vacant;
+		myGenerations.Mutable(aHandle.myIndex) = aPreviousGeneration;
+		myFreeSlots.Push(aHandle.myIndex);
+	}
+
+	void UnitStore::UndoDestroy(UnitHandle aHandle, uint32_t aDenseIndex, Team aTeam, uint8_t aNameId, int aDamage)
+	{
+		assert(!myFreeSlots.Empty() && myFreeSlots.Back() == aHandle.myIndex && "Destructions are undone newest first");
+
+		myFreeSlots.Pop();
+
+		if (aDenseIndex != myDenseToSlot.Size())
+		{
+			myTeams.Push(myTeams[aDenseIndex]);
+			myDamage.Push(myDamage[aDenseIndex]);
+			myNameIds.Push(myNameIds[aDenseIndex]);
+			myDenseToSlot.Push(myDenseToSlot[aDenseIndex]);
+
+			mySlotToDense.Mutable(myDenseToSlot.Back()) = static_cast<uint32_t>(myDenseToSlot.Size() - 1);
+
+			myTeams.Mutable(aDenseIndex) = aTeam;
+			myDamage.Mutable(aDenseIndex) = aDamage;
+			myNameIds.Mutable(aDenseIndex) = aNameId;
+			myDenseToSlot.Mutable(aDenseIndex) = aHandle.myIndex;
+		}
+		else
+		{
+			myTeams.Push(aTeam);
+			myDamage.Push(aDamage);
+			myNameIds.Push(aNameId);
+			myDenseToSlot.Push(aHandle.myIndex);
+		}
+
+		mySlotToDense.Mutable(aHandle.myIndex) = aDenseIndex;
+
+		myHash ^= KeyOf(aDenseIndex);
+	}
+
+	bool UnitStore::IsAlive(UnitHandle aHandle) const
+	{
+		return aHandle.myIndex < mySlotToDense.Size()
+			&& mySlotToDense[aHandle.myIndex] != Vacant
+			&& myGenerations[aHandle.myIndex] == aHandle.myGeneration;
+	}
+
+	bool UnitStore::IsDead(UnitHandle aHandle) const
+	{
+		return myDamage[mySlotToDense[aHandle.myIndex]] >= Health;
+	}
+
+	UnitHandle UnitStore::HandleAt(uint32_t aDenseIndex) const
+	{
+		uint32_t slot = myDenseToSlot[aDenseIndex];
+
+		return UnitHandle{ slot, myGenerations[slot] };
+	}
+
+	uint32_t UnitStore::DenseIndexOf(UnitHandle aHandle) const
+	{
+		return mySlotToDense[aHandle.myIndex];
+	}
+
+	Team UnitStore::GetTeam(UnitHandle aHandle) const
+	{
+		return myTeams[mySlotToDense[aHandle.myIndex]];
+	}
+
+	int UnitStore::GetDamage(UnitHandle aHandle) const
+	{
+		return myDamage[mySlotToDense[aHandle.myIndex]];
+	}
+
+	uint8_t UnitStore::GetNameId(UnitHandle aHandle) const
+	{
+		return myNameIds[mySlotToDense[aHandle.myIndex]];
+	}
+
+	float UnitStore::GetHealthPercent(UnitHandle aHandle) const
+	{
+		return 1.f - static_cast<float>(GetDamage(aHandle)) / static_cast<float>(Health);
+	}
+
+	void UnitStore::AddDamage(UnitHandle aHandle, int aAmount)
+	{
+		uint32_t dense = mySlotToDense[aHandle.myIndex];
+
+		myHash ^= KeyOf(dense);
+		myDamage.Mutable(dense) += aAmount;
+		myHash ^= KeyOf(dense);
+	}
+
+	void UnitStore::AddDamage(std::span<const int> aAmounts)
+	{
+		static_assert(decltype(myDamage)::ChunkSize == decltype(myDenseToSlot)::ChunkSize);
+
+		for (size_t chunk = 0; chunk < myDamage.ChunkCount(); chunk++)
+		{
+			std::span<const uint32_t> slots = myDenseToSlot.ChunkAt(chunk);
+
+			bool hit = false;
+
+			for (uint32_t slot : slots)
+				hit |= slot < aAmounts.size() && aAmounts[slot] != 0;
+
+			if (!hit)
+				continue;
+
+			std::span<int> damage = myDamage.MutableChunkAt(chunk);
+			uint32_t first = static_cast<uint32_t>(chunk * decltype(myDamage)::ChunkSize);
+
+			for (size_t i = 0; i < damage.size(); i++)
+			{
+				int amount = slots[i] < aAmounts.size() ? aAmounts[slots[i]] : 0;
+
+				if (amount == 0)
+					continue;
+
+				myHash ^= KeyOf(first + static_cast<uint32_t>(i));
+				damage[i] += amount;
+				myHash ^= KeyOf(first + static_cast<uint32_t>(i));
+			}
+		}
+	}
+
+	size_t UnitStore::Count() const
+	{
+		return myDenseToSlot.Size();
+	}
+
+	size_t UnitStore::Bytes() const
+	{
+		return myTeams.Bytes()
+			+ myDamage.Bytes()
+			+ myNameIds.Bytes()
+			+ myDenseToSlot.Bytes()
+			+ mySlotToDense.Bytes()
+			+ myGenerations.Bytes()
+			+ myFreeSlots.Bytes();
+	}
+
+	size_t UnitStore::OwnedBytes() const
+	{
+		return myTeams.OwnedBytes()
+			+ myDamage.OwnedBytes()
+			+ myNameIds.OwnedBytes()
+			+ myDenseToSlot.OwnedBytes()
+			+ mySlotToDense.OwnedBytes()
+			+ myGenerations.OwnedBytes()
+			+ myFreeSlots.OwnedBytes();
+	}
+
+	uint64_t UnitStore::Hash() const
+	{
+		return myHash;
+	}
+
+	uint64_t UnitStore::KeyOf(uint32_t aDenseIndex) const
+	{
+		uint32_t slot = myDenseToSlot[aDenseIndex];
+
+		return ZobristKey(myGenerations[slot], static_cast<uint64_t>(myTeams[aDenseIndex]), myNameIds[aDenseIndex], static_cast<uint64_t>(myDamage[aDenseIndex]));
+	}
+}
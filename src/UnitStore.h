@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "ChunkedColumn.h"
+
+namespace fisk
+{
+	enum class Team : uint8_t
+	{
+		Friend,
+		Foe
+	};
+
+	constexpr size_t TeamCount = 2;
+
+	struct UnitHandle
+	{
+		uint32_t myIndex = UINT32_MAX;
+		uint32_t myGeneration = 0;
+
+		bool operator==(const UnitHandle& aOther) const = default;
+	};
+
+	// Live units as struct-of-arrays columns. Copies share column chunks until one of them writes to it.
+	class UnitStore
+	{
+	public:
+		static constexpr int Health = 15;
+		static constexpr uint32_t Vacant = UINT32_MAX;
+
+		static const char* NameOf(uint8_t aNameId);
+		static uint8_t NextNameId();
+
+		UnitHandle Create(Team aTeam, uint8_t aNameId, uint32_t aGeneration);
+		void Destroy(UnitHandle aHandle);
+		void Clear();
+
+		uint32_t NextGeneration() const;
+		void UndoCreate(UnitHandle aHandle, uint32_t aPreviousGeneration);
+		void UndoDestroy(UnitHandle aHandle, uint32_t aDenseIndex, Team aTeam, uint8_t aNameId, int aDamage);
+
+		bool IsAlive(UnitHandle aHandle) const;
+		bool IsDead(UnitHandle aHandle) const;
+		UnitHandle HandleAt(uint32_t aDenseIndex) const;
+		uint32_t DenseIndexOf(UnitHandle aHandle) const;
+
+		Team GetTeam(UnitHandle aHandle) const;
+		int GetDamage(UnitHandle aHandle) const;
+		uint8_t GetNameId(UnitHandle aHandle) const;
+		float GetHealthPercent(UnitHandle aHandle) const;
+
+		void AddDamage(UnitHandle aHandle, int aAmount);
+		// aAmounts is indexed by slot. Chunks of the damage column that nothing lands in are left shared.
+		void AddDamage(std::span<const int> aAmounts);
+
+		size_t Count() const;
+		size_t Bytes() const;
+		size_t OwnedBytes() const;
+		uint64_t Hash() const;
+
+		template<class Callback>
+		void ForEach(Callback&& aCallback) const;
+
+	private:
+		uint64_t KeyOf(uint32_t aDenseIndex) const;
+
+		ChunkedColumn<Team> myTeams;
+		ChunkedColumn<int> myDamage;
+		ChunkedColumn<uint8_t> myNameIds;
+		ChunkedColumn<uint32_t> myDenseToSlot;
+
+		ChunkedColumn<uint32_t> mySlotToDense;
+		ChunkedColumn<uint32_t> myGenerations;
+		ChunkedColumn<uint32_t> myFreeSlots;
+
+		uint64_t myHash = 0;
+	};
+
+	template<class Callback>
+	inline void UnitStore::ForEach(Callback&& aCallback) const
+	{
+		for (uint32_t dense = 0; dense < myDenseToSlot.Size(); dense++)
+			aCallback(HandleAt(dense));
+	}
+}
@@ -0,0 +1,109 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+namespace fisk
+{
+	WorkerPool::WorkerPool(size_t aThreads)
+		: myShares(std::make_unique<Share[]>(std::max<size_t>(aThreads, 1)))
+		, myParticipants(std::max<size_t>(aThreads, 1))
+	{
+		for (size_t participant = 1; participant < myParticipants; participant++)
+			myThreads.emplace_back(&WorkerPool::Run, this, participant);
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::lock_guard lock(myMutex);
+			myStopping = true;
+		}
+
+		myWake.notify_all();
+
+		for (std::thread& thread : myThreads)
+			thread.join();
+	}
+
+	size_t WorkerPool::GetThreadCount() const
+	{
+		return myParticipants;
+	}
+
+	void WorkerPool::Dispatch(size_t aCount, size_t aGrain, void (*aInvoke)(void*, size_t, size_t), void* aContext)
+	{
+		aGrain = std::max<size_t>(aGrain, 1);
+
+		if (myParticipants == 1 || aCount <= aGrain)
+		{
+			aInvoke(aContext, 0, aCount);
+			return;
+		}
+
+		size_t share = (aCount + myParticipants - 1) / myParticipants;
+
+		for (size_t participant = 0; participant < myParticipants; participant++)
+		{
+			myShares[participant].myNext.store(std::min(participant * share, aCount), std::memory_order_relaxed);
+			myShares[participant].myEnd = std::min((participant + 1) * share, aCount);
+		}
+
+		{
+			std::lock_guard lock(myMutex);
+			myInvoke = aInvoke;
+			myContext = aContext;
+			myGrain = aGrain;
+			myBusy = myParticipants - 1;
+			myGeneration++;
+		}
+
+		myWake.notify_all();
+
+		Work(0);
+
+		std::unique_lock lock(myMutex);
+		myDone.wait(lock, [this]() { return myBusy == 0; });
+	}
+
+	void WorkerPool::Run(size_t aParticipant)
+	{
+		uint64_t seen = 0;
+
+		while (true)
+		{
+			std::unique_lock lock(myMutex);
+			myWake.wait(lock, [&]() { return myStopping || myGeneration != seen; });
+
+			if (myStopping)
+				return;
+
+			seen = myGeneration;
+			lock.unlock();
+
+			Work(aParticipant);
+
+			lock.lock();
+
+			if (--myBusy == 0)
+				myDone.notify_one();
+		}
+	}
+
+	void WorkerPool::Work(size_t aParticipant)
+	{
+		for (size_t offset = 0; offset < myParticipants; offset++)
+		{
+			Share& share = myShares[(aParticipant + offset) % myParticipants];
+
+			while (true)
+			{
+				size_t begin = share.myNext.fetch_add(myGrain, std::memory_order_relaxed);
+
+				if (begin >= share.myEnd)
+					break;
+
+				myInvoke(myContext, begin, std::min(begin + myGrain, share.myEnd));
+			}
+		}
+	}
+}
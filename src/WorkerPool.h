@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace fisk
+{
+	// Fixed set of threads for data parallel loops. The range is split evenly between participants,
+	// the calling thread included; a participant that runs out of its own share steals grains from
+	// the others until the whole range is claimed.
+	class WorkerPool
+	{
+	public:
+		static constexpr size_t Grain = 64;
+
+		WorkerPool(size_t aThreads);
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		size_t GetThreadCount() const;
+
+		// Indices are claimed aGrain at a time, use a grain of 1 when every index is a large job
+		template<class Callback>
+		void ParallelFor(size_t aCount, Callback&& aCallback, size_t aGrain = Grain);
+
+	private:
+		struct alignas(64) Share
+		{
+			std::atomic<size_t> myNext = 0;
+			size_t myEnd = 0;
+		};
+
+		void Run(size_t aParticipant);
+		void Work(size_t aParticipant);
+		void Dispatch(size_t aCount, size_t aGrain, void (*aInvoke)(void*, size_t, size_t), void* aContext);
+
+		std::unique_ptr<Share[]> myShares;
+		size_t myParticipants;
+
+		void (*myInvoke)(void*, size_t, size_t) = nullptr;
+		void* myContext = nullptr;
+		size_t myGrain = Grain;
+
+		std::mutex myMutex;
+		std::condition_variable myWake;
+		std::condition_variable myDone;
+		uint64_t myGeneration = 0;
+		size_t myBusy = 0;
+		bool myStopping = false;
+
+		std::vector<std::thread> myThreads;
+	};
+
+	template<class Callback>
+	inline void WorkerPool::ParallelFor(size_t aCount, Callback&& aCallback, size_t aGrain)
+	{
+		auto invoke = [](void* aContext, size_t aBegin, size_t aEnd)
+		{
+			Callback& callback = *static_cast<std::remove_reference_t<Callback>*>(aContext);
+
+			for (size_t i = aBegin; i < aEnd; i++)
+				callback(i);
+		};
+
+		Dispatch(aCount, aGrain, invoke, &aCallback);
+	}
+}
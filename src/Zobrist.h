@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+namespace fisk
+{
+	constexpr uint64_t ZobristKey(uint64_t aFeature, uint64_t aValue)
+	{
+		uint64_t key = aFeature * 0x9E3779B97F4A7C15ull ^ (aValue + 0x632BE59BD9B4E019ull);
+
+		key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+		key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+
+		return key ^ (key >> 31);
+	}
+
+	template<class... Values>
+	constexpr uint64_t ZobristKey(uint64_t aFeature, uint64_t aValue, Values... aRest)
+	{
+		return ZobristKey(ZobristKey(aFeature, aValue), aRest...);
+	}
+}
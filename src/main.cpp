@@ -70,6 +70,7 @@ int main(int argc, char** argv)
 	static arcospheres::Operation NaqTesseract1 = { .myTakes = { arcospheres::Lambda, arcospheres::Xi, arcospheres::Zeta }, .myMakes = { arcospheres::Theta, arcospheres::Epsilon, arcospheres::Phi } };
 	static arcospheres::Operation NaqTesseract2 = { .myTakes = { arcospheres::Lambda, arcospheres::Xi, arcospheres::Zeta }, .myMakes = { arcospheres::Phi, arcospheres::Gamma, arcospheres::Omega } };
 	static int StepSpeed = 1000;
+	static int SearchMode = static_cast<int>(arcospheres::FuturePath::Search::Bidirectional);
 
 	static int amount[10] = { 0 };
 
@@ -113,6 +114,9 @@ int main(int argc, char** argv)
 			ImGui::EndTable();
 		}
 
+		const char* searchModes[] = { "Breadth first", "Bidirectional", "A*", "IDA*", "Breadth first (dense)", "Breadth first (dense, threaded)" };
+		modified |= ImGui::Combo("Search", &SearchMode, searchModes, static_cast<int>(std::size(searchModes)));
+
 		arcospheres::State fromState = BaseState;
 
 		for (int i = 0; i < amount[0]; i++)
@@ -141,7 +145,7 @@ int main(int argc, char** argv)
 			if (path)
 				delete path;
 
-			path = new arcospheres::FuturePath(fromState, BaseState);
+			path = new arcospheres::FuturePath(fromState, BaseState, static_cast<arcospheres::FuturePath::Search>(SearchMode));
 		}
 
 		ImGui::InputInt("Steps per frame", &StepSpeed);
@@ -157,7 +161,7 @@ int main(int argc, char** argv)
 		{
 			path->Step(StepSpeed);
 
-			ImGui::Text("Steps: %u", path->mySteps);
+			ImGui::Text("Steps: %u, expanded: %llu, stored: %zu", path->mySteps, static_cast<unsigned long long>(path->myExpanded), path->GetStoredNodes());
 
 			if (path->Done())
 			{